@@ -1,11 +1,18 @@
 #version 460 core
 in vec2 TexCoord;
+flat in vec2 Tile;
 
 uniform sampler2D atlas;
 
 out vec4 FragColor;
 
+const float ATLAS_CELL_SIZE = 1.0 / 16.0;
+
 void main()
 {
-    FragColor = texture(atlas, TexCoord);
+    // TexCoord is tile-local and spans merged quads in blocks, so wrap it into the atlas cell.
+    // Gradients come from the unwrapped coordinate to avoid mip seams at tile boundaries.
+    vec2 uv = (Tile + fract(TexCoord)) * ATLAS_CELL_SIZE;
+    FragColor = textureGrad(atlas, uv, dFdx(TexCoord) * ATLAS_CELL_SIZE,
+                            dFdy(TexCoord) * ATLAS_CELL_SIZE);
 }
\ No newline at end of file
@@ -1,15 +1,41 @@
 #version 460 core
-layout (location = 0) in vec3 aPos;
-layout (location = 1) in vec2 aTexCoord;
+layout (location = 0) in uint aData;
+layout (location = 1) in ivec2 aChunkPos;  // Only set when drawing from the mesh arena
+
+// Written once per frame by Renderer::updateCameraBuffer
+layout (std140) uniform CameraMatrices
+{
+    mat4 view;
+    mat4 projection;
+};
 
 uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
 
 out vec2 TexCoord;
+flat out vec2 Tile;
+
+const uint ATLAS_CELLS = 16u;
+const int  CHUNK_SIZE  = 16;
 
 void main()
 {
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
-    TexCoord = aTexCoord;
+    // Unpack the vertex word written by ChunkMesh::packVertex
+    vec3 pos  = vec3(aData & 31u, (aData >> 5) & 511u, (aData >> 14) & 31u);
+    uint face = (aData >> 19) & 7u;
+    uint tile = (aData >> 22) & 255u;
+
+    // Tile-local UVs in blocks, oriented like the original per-face UVs
+    switch (face)
+    {
+        case 0u: TexCoord = vec2(pos.z, pos.y);   break; // left
+        case 1u: TexCoord = vec2(-pos.z, pos.y);  break; // right
+        case 2u: TexCoord = vec2(pos.x, pos.z);   break; // bottom
+        case 3u: TexCoord = vec2(pos.x, -pos.z);  break; // top
+        case 4u: TexCoord = vec2(-pos.x, pos.y);  break; // back
+        default: TexCoord = vec2(pos.x, pos.y);   break; // front
+    }
+
+    vec3 chunkOffset = vec3(aChunkPos.x * CHUNK_SIZE, 0, aChunkPos.y * CHUNK_SIZE);
+    gl_Position = projection * view * model * vec4(pos + chunkOffset, 1.0);
+    Tile = vec2(tile % ATLAS_CELLS, tile / ATLAS_CELLS);
 }
\ No newline at end of file
@@ -1,59 +1,5 @@
 #include "block.h"
 
-Block::Block(Id id) : id(id)
-{
-    switch (id)
-    {
-        case Id::AIR:
-            solid       = false;
-            transparent = true;
-            break;
-        case Id::WATER:
-            solid       = false;
-            transparent = true;
-            break;
-        default:
-            solid       = true;
-            transparent = false;
-            break;
-    }
-}
-
-AtlasCoords Block::getAtlasCoords(Block::Id id, Direction face)
-{
-    switch (id)
-    {
-        case Id::GRASS:
-            if (face == Direction::TOP)
-                return AtlasCoords{0, 15};
-            else if (face == Direction::BOTTOM)
-                return AtlasCoords{2, 15};
-            else
-                return AtlasCoords{1, 15};
-        case Id::DIRT:
-            return {2, 15};
-        case Id::STONE:
-            return {3, 15};
-        default:
-            return {0, 0};
-    }
-}
-
-Block::Id Block::getId() const
-{
-    return id;
-}
-
-bool Block::isSolid() const
-{
-    return solid;
-}
-
-bool Block::isTransparent() const
-{
-    return transparent;
-}
-
 // clang-format off
 const GLfloat Block::VERTICES[] = {
 	0, 0, 0,
@@ -2,6 +2,9 @@
 
 #include <glad/glad.h>
 
+#include <cstddef>
+#include <cstdint>
+
 struct AtlasCoords
 {
     int x, y;
@@ -20,7 +23,7 @@ enum class Direction
 class Block
 {
    public:
-    enum class Id
+    enum class Id : uint8_t
     {
         AIR,
         GRASS,
@@ -31,11 +34,12 @@ class Block
         LEAVES,
         WATER,
         LAVA,
+        COUNT
     };
 
-    Block(Id id);
-
-    static AtlasCoords getAtlasCoords(Id id, Direction face);
+    constexpr Block(Id id = Id::AIR) : id(id)
+    {
+    }
 
     Id   getId() const;
     bool isSolid() const;
@@ -49,7 +53,80 @@ class Block
     static const GLuint  INDICES[INDEX_COUNT];
 
    private:
-    Id   id;
-    bool solid;
-    bool transparent;
-};
\ No newline at end of file
+    Id id;
+};
+
+// Static per-type block properties, stored as parallel arrays indexed by Block::Id
+struct BlockRegistry
+{
+    static constexpr size_t COUNT = static_cast<size_t>(Block::Id::COUNT);
+
+    // clang-format off
+    static constexpr bool SOLID_FLAGS[COUNT] = {
+        false, // AIR
+        true,  // GRASS
+        true,  // DIRT
+        true,  // STONE
+        true,  // SAND
+        true,  // WOOD
+        true,  // LEAVES
+        false, // WATER
+        true,  // LAVA
+    };
+
+    static constexpr bool TRANSPARENT_FLAGS[COUNT] = {
+        true,  // AIR
+        false, // GRASS
+        false, // DIRT
+        false, // STONE
+        false, // SAND
+        false, // WOOD
+        false, // LEAVES
+        true,  // WATER
+        false, // LAVA
+    };
+
+    // Atlas cell per face, in Direction order: left, right, bottom, top, back, front
+    static constexpr AtlasCoords ATLAS_COORDS[COUNT][6] = {
+        {{0, 0},  {0, 0},  {0, 0},  {0, 0},  {0, 0},  {0, 0}},  // AIR
+        {{1, 15}, {1, 15}, {2, 15}, {0, 15}, {1, 15}, {1, 15}}, // GRASS
+        {{2, 15}, {2, 15}, {2, 15}, {2, 15}, {2, 15}, {2, 15}}, // DIRT
+        {{3, 15}, {3, 15}, {3, 15}, {3, 15}, {3, 15}, {3, 15}}, // STONE
+        {{0, 0},  {0, 0},  {0, 0},  {0, 0},  {0, 0},  {0, 0}},  // SAND
+        {{0, 0},  {0, 0},  {0, 0},  {0, 0},  {0, 0},  {0, 0}},  // WOOD
+        {{0, 0},  {0, 0},  {0, 0},  {0, 0},  {0, 0},  {0, 0}},  // LEAVES
+        {{0, 0},  {0, 0},  {0, 0},  {0, 0},  {0, 0},  {0, 0}},  // WATER
+        {{0, 0},  {0, 0},  {0, 0},  {0, 0},  {0, 0},  {0, 0}},  // LAVA
+    };
+    // clang-format on
+
+    static constexpr bool isSolid(Block::Id id)
+    {
+        return SOLID_FLAGS[static_cast<size_t>(id)];
+    }
+
+    static constexpr bool isTransparent(Block::Id id)
+    {
+        return TRANSPARENT_FLAGS[static_cast<size_t>(id)];
+    }
+
+    static constexpr AtlasCoords getAtlasCoords(Block::Id id, Direction face)
+    {
+        return ATLAS_COORDS[static_cast<size_t>(id)][static_cast<size_t>(face)];
+    }
+};
+
+inline Block::Id Block::getId() const
+{
+    return id;
+}
+
+inline bool Block::isSolid() const
+{
+    return BlockRegistry::isSolid(id);
+}
+
+inline bool Block::isTransparent() const
+{
+    return BlockRegistry::isTransparent(id);
+}
@@ -1,12 +1,13 @@
 #include "chunk.h"
+#include "chunk_neighborhood.h"
 #include "zlib/zlib.h"
 
-#include <glm/vec2.hpp>
+#include <algorithm>
 #include <stdexcept>
 
 // clang-format off
 namespace {
-    const GLfloat faceVertexOffsets[6][12] = {
+    constexpr int faceVertexOffsets[6][12] = {
         {0,0,0, 0,0,1, 0,1,1, 0,1,0}, // left
         {1,0,1, 1,0,0, 1,1,0, 1,1,1}, // right
         {0,0,0, 1,0,0, 1,0,1, 0,0,1}, // bottom
@@ -15,11 +16,25 @@ namespace {
         {0,0,1, 1,0,1, 1,1,1, 0,1,1}  // front
     };
     constexpr GLuint faceIndices[6] = {0, 1, 2, 0, 2, 3};
+
+    // Normal axis, in-plane (u, v) axes and outward step along the normal for each face
+    struct FaceAxes { int normal, u, v, step; };
+    constexpr FaceAxes faceAxes[6] = {
+        {0, 2, 1, -1}, // left
+        {0, 2, 1,  1}, // right
+        {1, 0, 2, -1}, // bottom
+        {1, 0, 2,  1}, // top
+        {2, 0, 1, -1}, // back
+        {2, 0, 1,  1}  // front
+    };
+
+    constexpr int atlasCells = 16;
 }
 // clang-format on
 
-Chunk::Chunk(int x, int z)
-    : chunkX(x), chunkZ(z), blocks(WIDTH * HEIGHT * DEPTH, Block(Block::Id::AIR))
+GLuint Chunk::quadEBO = 0;
+
+Chunk::Chunk(int x, int z) : chunkX(x), chunkZ(z)
 {
 }
 
@@ -29,7 +44,7 @@ Block Chunk::getBlock(int x, int y, int z) const
     {
         throw std::out_of_range("Block coordinates out of range");
     }
-    return blocks[x + WIDTH * (z + DEPTH * y)];
+    return blockIdAt(x, y, z);
 }
 
 void Chunk::setBlock(int x, int y, int z, const Block& block)
@@ -38,16 +53,47 @@ void Chunk::setBlock(int x, int y, int z, const Block& block)
     {
         throw std::out_of_range("Block coordinates out of range");
     }
-    blocks[x + WIDTH * (z + DEPTH * y)] = block;
+    sections[y / ChunkSection::SIZE].setBlock(x, y % ChunkSection::SIZE, z, block.getId());
+    dirty = true;
+}
+
+void Chunk::compactSections()
+{
+    for (ChunkSection& section : sections)
+        section.compact();
 }
 
 std::vector<uint8_t> Chunk::serialize() const
 {
     std::vector<uint8_t> rawData;
-    rawData.reserve(blocks.size());
-    for (const Block& block : blocks)
+    rawData.push_back(FORMAT_VERSION);
+
+    uint16_t sectionMask = 0;
+    for (int i = 0; i < SECTION_COUNT; ++i)
+    {
+        if (!sections[i].isEmpty())
+            sectionMask |= 1 << i;
+    }
+    rawData.push_back((sectionMask >> 8) & 0xFF);
+    rawData.push_back(sectionMask & 0xFF);
+
+    // Empty sections are skipped entirely, uniform ones are stored as a single id
+    for (const ChunkSection& section : sections)
     {
-        rawData.push_back(static_cast<uint8_t>(block.getId()));
+        if (section.isEmpty())
+            continue;
+
+        if (section.isUniform())
+        {
+            rawData.push_back(SECTION_UNIFORM);
+            rawData.push_back(static_cast<uint8_t>(section.getUniformId()));
+        }
+        else
+        {
+            const uint8_t* ids = reinterpret_cast<const uint8_t*>(section.data());
+            rawData.push_back(SECTION_FULL);
+            rawData.insert(rawData.end(), ids, ids + ChunkSection::VOLUME);
+        }
     }
 
     uLongf               compressedSize = compressBound(rawData.size());
@@ -73,97 +119,375 @@ std::vector<uint8_t> Chunk::serialize() const
     return serializedData;
 }
 
-void Chunk::generateMesh()
+// Safe to call off the main thread: reads only this chunk's blocks and the neighbor snapshot
+ChunkMesh Chunk::generateMesh(const ChunkNeighborhood& neighbors, MeshingMode mode) const
 {
-    meshVertices.clear();
-    meshIndices.clear();
-    GLuint indexOffset = 0;
+    ChunkMesh result;
+    if (mode == MeshingMode::GREEDY)
+        generateGreedyMesh(result, neighbors);
+    else
+        generatePerFaceMesh(result, neighbors);
+
+    result.updateVerticalExtent();
+    return result;
+}
 
-    for (int y = 0; y < HEIGHT; ++y)
+// Only the outward faces of the border layers look across to a neighbor, so every other quad of
+// the cached mesh is kept. Like generateMesh, safe to call off the main thread.
+ChunkMesh Chunk::remeshBorders(const ChunkMesh& cached, const ChunkNeighborhood& neighbors,
+                               MeshingMode mode) const
+{
+    if (!cached.neighbors)
+        return generateMesh(neighbors, mode);
+
+    const Direction sides[4]   = {Direction::LEFT, Direction::RIGHT, Direction::BACK,
+                                  Direction::FRONT};
+    bool            changed[6] = {};
+    for (Direction side : sides)
+        changed[static_cast<int>(side)] = !neighbors.hasSameBorder(*cached.neighbors, side);
+
+    // A face pointing out of the chunk has all its vertices on the chunk edge
+    auto isStale = [&](GLuint vertex)
     {
-        for (int z = 0; z < DEPTH; ++z)
+        Direction face = ChunkMesh::unpackFace(vertex);
+        if (!changed[static_cast<int>(face)])
+            return false;
+        switch (face)
         {
-            for (int x = 0; x < WIDTH; ++x)
-            {
-                Block block = getBlock(x, y, z);
-                if (!block.isSolid())
-                    continue;
+            case Direction::LEFT:
+                return ChunkMesh::unpackX(vertex) == 0;
+            case Direction::RIGHT:
+                return ChunkMesh::unpackX(vertex) == WIDTH;
+            case Direction::BACK:
+                return ChunkMesh::unpackZ(vertex) == 0;
+            default:
+                return ChunkMesh::unpackZ(vertex) == DEPTH;
+        }
+    };
+
+    ChunkMesh result;
+    result.vertices.reserve(cached.vertices.size());
+    for (size_t quad = 0; quad < cached.vertices.size(); quad += 4)
+    {
+        if (!isStale(cached.vertices[quad]))
+            result.vertices.insert(result.vertices.end(), cached.vertices.begin() + quad,
+                                   cached.vertices.begin() + quad + 4);
+    }
 
-                for (int face = 0; face < 6; ++face)
+    int lo[3], hi[3];
+    if (getMeshBounds(lo, hi))
+    {
+        std::vector<int> mask;
+        for (Direction side : sides)
+        {
+            if (changed[static_cast<int>(side)])
+                addBorderFaces(result, neighbors, side, mode, lo, hi, mask);
+        }
+    }
+
+    result.updateVerticalExtent();
+    return result;
+}
+
+// Bound culling by the geometry, not the full column, so the empty sky doesn't keep it visible
+void ChunkMesh::updateVerticalExtent()
+{
+    minY = 0;
+    maxY = 0;
+    if (vertices.empty())
+        return;
+
+    minY = Chunk::HEIGHT;
+    for (GLuint vertex : vertices)
+    {
+        int y = unpackY(vertex);
+        minY  = std::min(minY, y);
+        maxY  = std::max(maxY, y);
+    }
+}
+
+void Chunk::setMesh(ChunkMesh&& newMesh)
+{
+    mesh          = std::move(newMesh);
+    meshGenerated = true;
+}
+
+// Faces on the chunk border are culled against the neighbor snapshot; above and below the chunk
+// everything is open
+bool Chunk::isSolidAt(int x, int y, int z, const ChunkNeighborhood& neighbors) const
+{
+    if (y < 0 || y >= HEIGHT)
+        return false;
+    if (x < 0)
+        return neighbors.isSolid(Direction::LEFT, z, y);
+    if (x >= WIDTH)
+        return neighbors.isSolid(Direction::RIGHT, z, y);
+    if (z < 0)
+        return neighbors.isSolid(Direction::BACK, x, y);
+    if (z >= DEPTH)
+        return neighbors.isSolid(Direction::FRONT, x, y);
+    return BlockRegistry::isSolid(blockIdAt(x, y, z));
+}
+
+void Chunk::generatePerFaceMesh(ChunkMesh& target, const ChunkNeighborhood& neighbors) const
+{
+    for (int sectionIndex = 0; sectionIndex < SECTION_COUNT; ++sectionIndex)
+    {
+        const ChunkSection& section = sections[sectionIndex];
+        if (section.isEmpty())
+            continue;
+
+        int baseY = sectionIndex * ChunkSection::SIZE;
+        for (int ly = 0; ly < ChunkSection::SIZE; ++ly)
+        {
+            int y = baseY + ly;
+            for (int z = 0; z < DEPTH; ++z)
+            {
+                for (int x = 0; x < WIDTH; ++x)
                 {
-                    Direction dir = static_cast<Direction>(face);
-                    int       nx = x, ny = y, nz = z;
-                    switch (dir)
-                    {
-                        case Direction::LEFT:
-                            nx = x - 1;
-                            break;  // left
-                        case Direction::RIGHT:
-                            nx = x + 1;
-                            break;  // right
-                        case Direction::BOTTOM:
-                            ny = y - 1;
-                            break;  // bottom
-                        case Direction::TOP:
-                            ny = y + 1;
-                            break;  // top
-                        case Direction::BACK:
-                            nz = z - 1;
-                            break;  // back
-                        case Direction::FRONT:
-                            nz = z + 1;
-                            break;  // front
-                    }
-                    bool neighborSolid = false;
-                    if (nx >= 0 && nx < WIDTH && ny >= 0 && ny < HEIGHT && nz >= 0 && nz < DEPTH)
+                    if (!BlockRegistry::isSolid(section.getBlock(x, ly, z)))
+                        continue;
+
+                    for (int face = 0; face < 6; ++face)
                     {
-                        neighborSolid = getBlock(nx, ny, nz).isSolid();
+                        Direction dir = static_cast<Direction>(face);
+                        int       nx = x, ny = y, nz = z;
+                        switch (dir)
+                        {
+                            case Direction::LEFT:
+                                nx = x - 1;
+                                break;  // left
+                            case Direction::RIGHT:
+                                nx = x + 1;
+                                break;  // right
+                            case Direction::BOTTOM:
+                                ny = y - 1;
+                                break;  // bottom
+                            case Direction::TOP:
+                                ny = y + 1;
+                                break;  // top
+                            case Direction::BACK:
+                                nz = z - 1;
+                                break;  // back
+                            case Direction::FRONT:
+                                nz = z + 1;
+                                break;  // front
+                        }
+                        if (isSolidAt(nx, ny, nz, neighbors))
+                            continue;
+
+                        addFace(target, x, y, z, dir);
                     }
-                    if (neighborSolid)
-                        continue;
+                }
+            }
+        }
+    }
+}
+
+// Block range that can produce faces: the full width and depth, and the occupied sections. False
+// for an empty chunk.
+bool Chunk::getMeshBounds(int lo[3], int hi[3]) const
+{
+    int lowestSection = 0, highestSection = SECTION_COUNT - 1;
+    while (lowestSection < SECTION_COUNT && sections[lowestSection].isEmpty())
+        ++lowestSection;
+    while (highestSection >= lowestSection && sections[highestSection].isEmpty())
+        --highestSection;
+    if (lowestSection > highestSection)
+        return false;
+
+    lo[0] = 0;
+    lo[1] = lowestSection * ChunkSection::SIZE;
+    lo[2] = 0;
+    hi[0] = WIDTH;
+    hi[1] = (highestSection + 1) * ChunkSection::SIZE;
+    hi[2] = DEPTH;
+    return true;
+}
+
+// Merges coplanar, adjacent faces sharing an atlas tile into larger quads, one face direction and
+// one layer at a time. The shader repeats the tile across the quad using the tile-local UVs.
+void Chunk::generateGreedyMesh(ChunkMesh& target, const ChunkNeighborhood& neighbors) const
+{
+    int lo[3], hi[3];
+    if (!getMeshBounds(lo, hi))
+        return;
 
-                    addFace(x, y, z, dir, indexOffset);
+    std::vector<int> mask;
+    for (int face = 0; face < 6; ++face)
+    {
+        int normal = faceAxes[face].normal;
+        for (int layer = lo[normal]; layer < hi[normal]; ++layer)
+        {
+            if (normal == 1 && sections[layer / ChunkSection::SIZE].isEmpty())
+                continue;
+            addGreedyLayer(target, neighbors, static_cast<Direction>(face), layer, lo, hi, mask);
+        }
+    }
+}
+
+// Faces of the border layer on one side that point into the neighbor
+void Chunk::addBorderFaces(ChunkMesh& target, const ChunkNeighborhood& neighbors, Direction side,
+                           MeshingMode mode, const int lo[3], const int hi[3],
+                           std::vector<int>& mask) const
+{
+    const FaceAxes& axes  = faceAxes[static_cast<int>(side)];
+    int             layer = axes.step < 0 ? 0 : hi[axes.normal] - 1;
+    if (mode == MeshingMode::GREEDY)
+    {
+        addGreedyLayer(target, neighbors, side, layer, lo, hi, mask);
+        return;
+    }
+
+    for (int v = lo[axes.v]; v < hi[axes.v]; ++v)
+    {
+        for (int u = lo[axes.u]; u < hi[axes.u]; ++u)
+        {
+            int pos[3];
+            pos[axes.normal] = layer;
+            pos[axes.u]      = u;
+            pos[axes.v]      = v;
+            if (!BlockRegistry::isSolid(blockIdAt(pos[0], pos[1], pos[2])))
+                continue;
+
+            int across[3] = {pos[0], pos[1], pos[2]};
+            across[axes.normal] += axes.step;
+            if (!isSolidAt(across[0], across[1], across[2], neighbors))
+                addFace(target, pos[0], pos[1], pos[2], side);
+        }
+    }
+}
+
+void Chunk::addGreedyLayer(ChunkMesh& target, const ChunkNeighborhood& neighbors, Direction dir,
+                           int layer, const int lo[3], const int hi[3],
+                           std::vector<int>& mask) const
+{
+    const FaceAxes& axes  = faceAxes[static_cast<int>(dir)];
+    int             uSize = hi[axes.u] - lo[axes.u];
+    int             vSize = hi[axes.v] - lo[axes.v];
+    mask.assign(uSize * vSize, 0);
+
+    // Mask holds 1 + atlas tile index for every visible face in this layer, 0 otherwise
+    bool anyFace = false;
+    for (int v = 0; v < vSize; ++v)
+    {
+        for (int u = 0; u < uSize; ++u)
+        {
+            int pos[3];
+            pos[axes.normal] = layer;
+            pos[axes.u]      = lo[axes.u] + u;
+            pos[axes.v]      = lo[axes.v] + v;
+
+            int       key = 0;
+            Block::Id id  = blockIdAt(pos[0], pos[1], pos[2]);
+            if (BlockRegistry::isSolid(id))
+            {
+                pos[axes.normal] += axes.step;
+                if (!isSolidAt(pos[0], pos[1], pos[2], neighbors))
+                {
+                    AtlasCoords tile = BlockRegistry::getAtlasCoords(id, dir);
+                    key              = 1 + tile.x + tile.y * atlasCells;
+                    anyFace          = true;
                 }
             }
+            mask[u + v * uSize] = key;
+        }
+    }
+    if (!anyFace)
+        return;
+
+    for (int v = 0; v < vSize; ++v)
+    {
+        for (int u = 0; u < uSize;)
+        {
+            int key = mask[u + v * uSize];
+            if (key == 0)
+            {
+                ++u;
+                continue;
+            }
+
+            // Grow along u, then along v while the whole row still matches
+            int width = 1;
+            while (u + width < uSize && mask[u + width + v * uSize] == key)
+                ++width;
+
+            int height = 1;
+            for (; v + height < vSize; ++height)
+            {
+                int k = 0;
+                while (k < width && mask[u + k + (v + height) * uSize] == key)
+                    ++k;
+                if (k < width)
+                    break;
+            }
+
+            for (int dv = 0; dv < height; ++dv)
+            {
+                for (int du = 0; du < width; ++du)
+                    mask[u + du + (v + dv) * uSize] = 0;
+            }
+
+            int pos[3];
+            pos[axes.normal] = layer;
+            pos[axes.u]      = lo[axes.u] + u;
+            pos[axes.v]      = lo[axes.v] + v;
+
+            int size[3];
+            size[axes.normal] = 1;
+            size[axes.u]      = width;
+            size[axes.v]      = height;
+
+            AtlasCoords tile = {(key - 1) % atlasCells, (key - 1) / atlasCells};
+            addQuad(target, pos, size, dir, tile);
+
+            u += width;
         }
     }
-    meshGenerated = true;
 }
 
-void Chunk::uploadMeshToGPU()
+void Chunk::uploadMeshToGPU(ChunkMeshArena* arena)
 {
+    if (arena)
+    {
+        // A remeshed chunk gets a fresh allocation sized for its new mesh
+        if (meshArena)
+            meshArena->release(arenaHandle);
+        meshArena   = arena;
+        arenaHandle = arena->upload(mesh.vertices);
+        return;
+    }
+
     if (VAO == 0)
         glGenVertexArrays(1, &VAO);
     if (VBO == 0)
         glGenBuffers(1, &VBO);
-    if (EBO == 0)
-        glGenBuffers(1, &EBO);
 
     glBindVertexArray(VAO);
 
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, meshVertices.size() * sizeof(GLfloat), meshVertices.data(),
+    glBufferData(GL_ARRAY_BUFFER, mesh.vertices.size() * sizeof(GLuint), mesh.vertices.data(),
                  GL_STATIC_DRAW);
 
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, meshIndices.size() * sizeof(GLuint), meshIndices.data(),
-                 GL_STATIC_DRAW);
+    // Every chunk VAO shares the same static quad index pattern
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, getQuadIndexBuffer());
 
-    // Position attribute (3 floats)
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(GLfloat), (void*) 0);
+    // Packed vertex attribute (1 uint, decoded in the vertex shader)
+    glVertexAttribIPointer(0, 1, GL_UNSIGNED_INT, sizeof(GLuint), (void*) 0);
     glEnableVertexAttribArray(0);
 
-    // Texture coordinate attribute (2 floats)
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(GLfloat),
-                          (void*) (3 * sizeof(GLfloat)));
-    glEnableVertexAttribArray(1);
-
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindVertexArray(0);
 }
 
-void Chunk::deleteMesh()
+void Chunk::releaseGPUMesh()
 {
+    if (meshArena)
+    {
+        meshArena->release(arenaHandle);
+        meshArena   = nullptr;
+        arenaHandle = ChunkMeshArena::INVALID_HANDLE;
+    }
     if (VAO != 0)
     {
         glDeleteVertexArrays(1, &VAO);
@@ -174,42 +498,67 @@ void Chunk::deleteMesh()
         glDeleteBuffers(1, &VBO);
         VBO = 0;
     }
-    if (EBO != 0)
-    {
-        glDeleteBuffers(1, &EBO);
-        EBO = 0;
-    }
+}
+
+void Chunk::deleteMesh()
+{
+    releaseGPUMesh();
     meshGenerated = false;
-    meshVertices.clear();
-    meshIndices.clear();
+    std::vector<GLuint>().swap(mesh.vertices);  // clear() keeps the capacity memoryUsage counts
+    mesh.neighbors.reset();
 }
 
-void Chunk::addFace(int x, int y, int z, Direction face, GLuint& indexOffset)
+size_t Chunk::memoryUsage() const
 {
-    const GLfloat* offsets = faceVertexOffsets[static_cast<int>(face)];
+    size_t bytes = sizeof(Chunk) + mesh.vertices.capacity() * sizeof(GLuint);
+    if (mesh.neighbors)
+        bytes += sizeof(ChunkNeighborhood);
+    for (const ChunkSection& section : sections)
+        bytes += section.memoryUsage() - sizeof(ChunkSection);
+    return bytes;
+}
 
-    constexpr float cellSize = 1.0f / 16.0f;
-    AtlasCoords     coords   = Block::getAtlasCoords(getBlock(x, y, z).getId(), face);
-    float           u_min    = coords.x * cellSize;
-    float           v_min    = coords.y * cellSize;
-    float           u_max    = u_min + cellSize;
-    float           v_max    = v_min + cellSize;
+void Chunk::addFace(ChunkMesh& target, int x, int y, int z, Direction face) const
+{
+    int pos[3]  = {x, y, z};
+    int size[3] = {1, 1, 1};
+    addQuad(target, pos, size, face, BlockRegistry::getAtlasCoords(blockIdAt(x, y, z), face));
+}
 
-    // UVs for the 4 face vertices (adjust order if needed)
-    glm::vec2 faceUVs[4] = {{u_min, v_min}, {u_max, v_min}, {u_max, v_max}, {u_min, v_max}};
+// Emits a face covering size[] blocks starting at pos[]; the size along the face normal must be 1.
+// Tile-local UVs are not stored: the shader derives them from the position and face.
+void Chunk::addQuad(ChunkMesh& target, const int pos[3], const int size[3], Direction face,
+                    AtlasCoords tile)
+{
+    const int* offsets   = faceVertexOffsets[static_cast<int>(face)];
+    GLuint     tileIndex = static_cast<GLuint>(tile.x + tile.y * atlasCells);
 
     for (int i = 0; i < 4; ++i)
     {
-        meshVertices.push_back(x + offsets[i * 3 + 0]);
-        meshVertices.push_back(y + offsets[i * 3 + 1]);
-        meshVertices.push_back(z + offsets[i * 3 + 2]);
-        meshVertices.push_back(faceUVs[i].x);
-        meshVertices.push_back(faceUVs[i].y);
+        GLuint x = pos[0] + offsets[i * 3 + 0] * size[0];
+        GLuint y = pos[1] + offsets[i * 3 + 1] * size[1];
+        GLuint z = pos[2] + offsets[i * 3 + 2] * size[2];
+        target.vertices.push_back(ChunkMesh::packVertex(x, y, z, face, tileIndex));
     }
-    // Add 6 indices for the face in order to make 2 tris
-    for (int i = 0; i < 6; ++i)
+}
+
+// Lazily builds the index buffer shared by all chunk meshes: quad k is drawn as the two triangles
+// (4k, 4k+1, 4k+2) and (4k, 4k+2, 4k+3), for as many quads as the largest possible chunk mesh
+GLuint Chunk::getQuadIndexBuffer()
+{
+    if (quadEBO != 0)
+        return quadEBO;
+
+    std::vector<GLuint> indices(MAX_QUADS * 6);
+    for (size_t quad = 0; quad < MAX_QUADS; ++quad)
     {
-        meshIndices.push_back(indexOffset + faceIndices[i]);
+        for (int i = 0; i < 6; ++i)
+            indices[quad * 6 + i] = static_cast<GLuint>(quad * 4) + faceIndices[i];
     }
-    indexOffset += 4;  // 4 vertices per face
-}
\ No newline at end of file
+
+    glGenBuffers(1, &quadEBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, quadEBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(),
+                 GL_STATIC_DRAW);
+    return quadEBO;
+}
@@ -1,10 +1,61 @@
 #pragma once
 
 #include "block.h"
+#include "chunk_mesh_arena.h"
+#include "chunk_section.h"
 
+#include <array>
+#include <memory>
 #include <vector>
 #include <cstdint>
 
+class ChunkNeighborhood;
+
+// Each vertex is one packed 32-bit word, unpacked in default.vert:
+// bits 0-4 x (0-16), 5-13 y (0-256), 14-18 z (0-16), 19-21 face direction, 22-29 atlas tile
+struct ChunkMesh
+{
+    std::vector<GLuint> vertices;  // 4 per quad; indices come from Chunk::getQuadIndexBuffer
+    int                 minY = 0, maxY = 0;  // Vertical extent of the geometry, for culling
+
+    // Neighbor borders the mesh was built against, to tell whether a cached mesh is still valid
+    std::shared_ptr<const ChunkNeighborhood> neighbors;
+
+    size_t getQuadCount() const
+    {
+        return vertices.size() / 4;
+    }
+
+    static GLuint packVertex(GLuint x, GLuint y, GLuint z, Direction face, GLuint tileIndex)
+    {
+        return x | (y << 5) | (z << 14) | (static_cast<GLuint>(face) << 19) | (tileIndex << 22);
+    }
+    static int unpackX(GLuint vertex)
+    {
+        return static_cast<int>(vertex & 31);
+    }
+    static int unpackY(GLuint vertex)
+    {
+        return static_cast<int>((vertex >> 5) & 511);
+    }
+    static int unpackZ(GLuint vertex)
+    {
+        return static_cast<int>((vertex >> 14) & 31);
+    }
+    static Direction unpackFace(GLuint vertex)
+    {
+        return static_cast<Direction>((vertex >> 19) & 7);
+    }
+
+    void updateVerticalExtent();
+};
+
+enum class MeshingMode
+{
+    PER_FACE,  // One quad per exposed block face
+    GREEDY,    // Adjacent coplanar faces with the same tile merged into larger quads
+};
+
 class Chunk
 {
    public:
@@ -12,15 +63,52 @@ class Chunk
     static const int HEIGHT = 256;  // Y-axis
     static const int DEPTH  = 16;   // Z-axis
 
-    std::vector<GLfloat> meshVertices;
-    std::vector<GLuint>  meshIndices;
-    GLuint               VAO = 0, VBO = 0, EBO = 0;
-    bool                 meshGenerated = false;
+    static const int SECTION_COUNT = HEIGHT / ChunkSection::SIZE;
+
+    // Worst case is a 3D checkerboard: half the blocks solid with all 6 faces exposed
+    static constexpr size_t MAX_QUADS = WIDTH * HEIGHT * DEPTH / 2 * 6;
+
+    // Serialized layout (before compression): format version, 16-bit mask of non-empty sections,
+    // then for each non-empty section a storage tag followed by one id or a full voxel array
+    static constexpr uint8_t FORMAT_VERSION  = 1;
+    static constexpr uint8_t SECTION_UNIFORM = 0;
+    static constexpr uint8_t SECTION_FULL    = 1;
+
+    ChunkMesh mesh;
+    GLuint    VAO = 0, VBO = 0;
+
+    // Set instead of VAO/VBO when the mesh lives in a shared arena
+    ChunkMeshArena*        meshArena   = nullptr;
+    ChunkMeshArena::Handle arenaHandle = ChunkMeshArena::INVALID_HANDLE;
+
+    bool      meshGenerated = false;
+    uint32_t  meshRevision  = 0;  // Latest mesh job issued for this chunk (main thread only)
 
     Chunk(int x, int z);
 
     Block getBlock(int x, int y, int z) const;
-    void  setBlock(int x, int y, int z, const Block& block);
+    void  setBlock(int x, int y, int z, const Block& block);  // Marks the chunk dirty
+
+    // Dirty chunks differ from what regenerating or reloading them would give, so only they need
+    // saving. Generated and loaded chunks are clean.
+    bool isDirty() const
+    {
+        return dirty;
+    }
+    void clearDirty()
+    {
+        dirty = false;
+    }
+
+    ChunkSection& getSection(int index)
+    {
+        return sections[index];
+    }
+    const ChunkSection& getSection(int index) const
+    {
+        return sections[index];
+    }
+    void compactSections();
 
     std::vector<uint8_t> serialize() const;
 
@@ -33,13 +121,45 @@ class Chunk
         return chunkZ;
     }
 
-    void generateMesh();
-    void uploadMeshToGPU();
-    void deleteMesh();
+    ChunkMesh generateMesh(const ChunkNeighborhood& neighbors,
+                           MeshingMode              mode = MeshingMode::GREEDY) const;
+    // Same result as generateMesh, reusing the faces of cached that do not touch a neighbor whose
+    // border changed since it was built
+    ChunkMesh remeshBorders(const ChunkMesh& cached, const ChunkNeighborhood& neighbors,
+                            MeshingMode mode = MeshingMode::GREEDY) const;
+    void      setMesh(ChunkMesh&& newMesh);
+    void      uploadMeshToGPU(ChunkMeshArena* arena = nullptr);
+    void      releaseGPUMesh();  // Frees GPU buffers but keeps the CPU-side mesh
+    void      deleteMesh();
+
+    // Approximate heap and object footprint, including the CPU-side mesh
+    size_t memoryUsage() const;
+
+    static GLuint getQuadIndexBuffer();
 
    private:
-    int                chunkX, chunkZ;
-    std::vector<Block> blocks;  // 1 byte per block
+    static GLuint quadEBO;
+
+    int                                     chunkX, chunkZ;
+    std::array<ChunkSection, SECTION_COUNT> sections;  // Bottom to top
+    bool                                    dirty = false;
+
+    Block::Id blockIdAt(int x, int y, int z) const
+    {
+        return sections[y / ChunkSection::SIZE].getBlock(x, y % ChunkSection::SIZE, z);
+    }
+
+    bool isSolidAt(int x, int y, int z, const ChunkNeighborhood& neighbors) const;
+    bool getMeshBounds(int lo[3], int hi[3]) const;
+    void generatePerFaceMesh(ChunkMesh& target, const ChunkNeighborhood& neighbors) const;
+    void generateGreedyMesh(ChunkMesh& target, const ChunkNeighborhood& neighbors) const;
+    void addGreedyLayer(ChunkMesh& target, const ChunkNeighborhood& neighbors, Direction dir,
+                        int layer, const int lo[3], const int hi[3], std::vector<int>& mask) const;
+    void addBorderFaces(ChunkMesh& target, const ChunkNeighborhood& neighbors, Direction side,
+                        MeshingMode mode, const int lo[3], const int hi[3],
+                        std::vector<int>& mask) const;
+    void addFace(ChunkMesh& target, int x, int y, int z, Direction face) const;
 
-    void addFace(int x, int y, int z, Direction face, GLuint& indexOffset);
+    static void addQuad(ChunkMesh& target, const int pos[3], const int size[3], Direction face,
+                        AtlasCoords tile);
 };
@@ -0,0 +1,69 @@
+#include "chunk_cache.h"
+
+ChunkCache::ChunkCache(size_t budgetMegabytes) : budgetBytes(budgetMegabytes * 1024 * 1024)
+{
+}
+
+void ChunkCache::setBudget(size_t megabytes)
+{
+    budgetBytes = megabytes * 1024 * 1024;
+    evict();
+}
+
+void ChunkCache::insert(std::shared_ptr<Chunk> chunk)
+{
+    auto key = std::make_pair(chunk->getX(), chunk->getZ());
+
+    // A chunk is only cached while unloaded, but replace rather than duplicate to stay safe
+    auto existing = index.find(key);
+    if (existing != index.end())
+    {
+        usedBytes -= existing->second->bytes;
+        entries.erase(existing->second);
+        index.erase(existing);
+    }
+
+    size_t bytes = chunk->memoryUsage();
+    if (bytes > budgetBytes)
+        return;
+
+    entries.push_front({std::move(chunk), bytes});
+    index[key] = entries.begin();
+    usedBytes += bytes;
+    evict();
+}
+
+std::shared_ptr<Chunk> ChunkCache::take(int chunkX, int chunkZ)
+{
+    auto it = index.find({chunkX, chunkZ});
+    if (it == index.end())
+    {
+        ++misses;
+        return nullptr;
+    }
+
+    ++hits;
+    std::shared_ptr<Chunk> chunk = std::move(it->second->chunk);
+    usedBytes -= it->second->bytes;
+    entries.erase(it->second);
+    index.erase(it);
+    return chunk;
+}
+
+void ChunkCache::clear()
+{
+    entries.clear();
+    index.clear();
+    usedBytes = 0;
+}
+
+void ChunkCache::evict()
+{
+    while (usedBytes > budgetBytes && !entries.empty())
+    {
+        const Entry& oldest = entries.back();
+        usedBytes -= oldest.bytes;
+        index.erase({oldest.chunk->getX(), oldest.chunk->getZ()});
+        entries.pop_back();
+    }
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "chunk.h"
+
+#include <list>
+#include <map>
+#include <memory>
+#include <utility>
+
+// Recently unloaded chunks kept in memory, so walking back over them skips the region file,
+// decompression and generation. Bounded by an approximate memory budget and evicted least
+// recently unloaded first. Main thread only.
+class ChunkCache
+{
+   public:
+    explicit ChunkCache(size_t budgetMegabytes);
+
+    void setBudget(size_t megabytes);
+
+    // Chunks bigger than the whole budget are not kept
+    void insert(std::shared_ptr<Chunk> chunk);
+    // Removes and returns the chunk, or nullptr on a miss
+    std::shared_ptr<Chunk> take(int chunkX, int chunkZ);
+    void                   clear();
+
+    size_t getHitCount() const
+    {
+        return hits;
+    }
+    size_t getMissCount() const
+    {
+        return misses;
+    }
+    size_t getMemoryUsage() const
+    {
+        return usedBytes;
+    }
+    size_t getChunkCount() const
+    {
+        return entries.size();
+    }
+
+   private:
+    struct Entry
+    {
+        std::shared_ptr<Chunk> chunk;
+        size_t                 bytes;
+    };
+
+    std::list<Entry>                                          entries;  // Most recent first
+    std::map<std::pair<int, int>, std::list<Entry>::iterator> index;
+
+    size_t budgetBytes;
+    size_t usedBytes = 0;
+    size_t hits = 0, misses = 0;
+
+    void evict();
+};
@@ -0,0 +1,54 @@
+#include "chunk_grid.h"
+
+const std::shared_ptr<Chunk> ChunkGrid::emptySlot;
+
+ChunkGrid::ChunkGrid(int size) : size(size), slots(static_cast<size_t>(size) * size)
+{
+}
+
+std::shared_ptr<Chunk> ChunkGrid::insert(std::shared_ptr<Chunk> chunk)
+{
+    std::shared_ptr<Chunk>& slot = slots[slotIndex(chunk->getX(), chunk->getZ())];
+    if (!slot)
+        ++chunkCount;
+
+    std::shared_ptr<Chunk> previous = std::move(slot);
+    slot                            = std::move(chunk);
+    return previous;
+}
+
+std::shared_ptr<Chunk> ChunkGrid::remove(int chunkX, int chunkZ)
+{
+    std::shared_ptr<Chunk>& slot = slots[slotIndex(chunkX, chunkZ)];
+    if (!slot || slot->getX() != chunkX || slot->getZ() != chunkZ)
+        return nullptr;
+
+    --chunkCount;
+    return std::move(slot);
+}
+
+std::vector<std::shared_ptr<Chunk>> ChunkGrid::resize(int newSize)
+{
+    std::vector<std::shared_ptr<Chunk>> oldSlots = std::move(slots);
+
+    size       = newSize;
+    chunkCount = 0;
+    slots.assign(static_cast<size_t>(size) * size, nullptr);
+
+    std::vector<std::shared_ptr<Chunk>> displaced;
+    for (std::shared_ptr<Chunk>& chunk : oldSlots)
+    {
+        if (!chunk)
+            continue;
+        if (auto previous = insert(std::move(chunk)))
+            displaced.push_back(std::move(previous));
+    }
+    return displaced;
+}
+
+void ChunkGrid::clear()
+{
+    for (std::shared_ptr<Chunk>& slot : slots)
+        slot.reset();
+    chunkCount = 0;
+}
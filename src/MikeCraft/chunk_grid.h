@@ -0,0 +1,63 @@
+#pragma once
+
+#include "chunk.h"
+
+#include <memory>
+#include <vector>
+
+// Square ring buffer of loaded chunks. Chunk (x, z) lives in slot (x mod size, z mod size), so any
+// (2r + 1)-wide square of chunks fits without collisions and lookups are plain array indexing.
+class ChunkGrid
+{
+   public:
+    explicit ChunkGrid(int size = 1);
+
+    int getSize() const
+    {
+        return size;
+    }
+    size_t getChunkCount() const
+    {
+        return chunkCount;
+    }
+
+    // Returns an empty pointer if (chunkX, chunkZ) is not loaded
+    const std::shared_ptr<Chunk>& get(int chunkX, int chunkZ) const
+    {
+        const std::shared_ptr<Chunk>& chunk = slots[slotIndex(chunkX, chunkZ)];
+        return chunk && chunk->getX() == chunkX && chunk->getZ() == chunkZ ? chunk : emptySlot;
+    }
+
+    // Returns the chunk previously occupying the slot, if any
+    std::shared_ptr<Chunk> insert(std::shared_ptr<Chunk> chunk);
+    std::shared_ptr<Chunk> remove(int chunkX, int chunkZ);
+
+    // Rebuilds the grid at a new size; chunks that no longer fit are returned
+    std::vector<std::shared_ptr<Chunk>> resize(int newSize);
+    void                                clear();
+
+    // Slot order, skipping empty slots
+    template <typename Func>
+    void forEach(Func&& func) const
+    {
+        for (const std::shared_ptr<Chunk>& chunk : slots)
+        {
+            if (chunk)
+                func(chunk);
+        }
+    }
+
+   private:
+    static const std::shared_ptr<Chunk> emptySlot;
+
+    int                                 size;
+    size_t                              chunkCount = 0;
+    std::vector<std::shared_ptr<Chunk>> slots;
+
+    size_t slotIndex(int chunkX, int chunkZ) const
+    {
+        int slotX = ((chunkX % size) + size) % size;
+        int slotZ = ((chunkZ % size) + size) % size;
+        return static_cast<size_t>(slotZ) * size + slotX;
+    }
+};
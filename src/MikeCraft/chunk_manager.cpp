@@ -4,12 +4,43 @@
 #include "world_generator.h"
 #include "zlib/zlib.h"
 
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <optional>
 #include <stdexcept>
 #include <vector>
 
-ChunkManager::ChunkManager(WorldGenerator& generator) : worldGenerator(generator)
+namespace
+{
+    // How many chunks closer a chunk straight ahead of the camera counts as
+    constexpr float viewDirectionBias = 2.0f;
+
+    // Spare ring around the render square so chunks with deferred unloads rarely share a grid slot
+    // with newly loaded ones
+    constexpr int gridMargin = 1;
+
+    // Unloads waiting for the writer before further unloads are deferred
+    constexpr size_t writeQueueCapacity = 64;
+
+    constexpr size_t defaultCacheBudgetMegabytes = 64;
+
+    // Up to about 200 KiB per region, less when the terrain formula leaves channels unused
+    constexpr size_t defaultNoiseBudgetMegabytes = 16;
+
+    // Temp frequency and seed
+    constexpr float noiseFrequency = 0.01f;
+    constexpr int   noiseSeed      = 0;
+}  // namespace
+
+ChunkManager::ChunkManager(WorldGenerator& generator, size_t workerCount)
+    : worldGenerator(generator),
+      noiseGrids(generator, noiseFrequency, defaultNoiseBudgetMegabytes),
+      chunkWriter([this](int chunkX, int chunkZ) { return getRegionFile(chunkX, chunkZ); },
+                  writeQueueCapacity),
+      chunkCache(defaultCacheBudgetMegabytes),
+      threadPool(workerCount)
 {
-    workerThread = std::thread(&ChunkManager::workerFunc, this);
 }
 
 ChunkManager::~ChunkManager()
@@ -20,98 +51,326 @@ ChunkManager::~ChunkManager()
 std::vector<Chunk*> ChunkManager::getLoadedChunks() const
 {
     std::vector<Chunk*> result;
-    for (const auto& pair : loadedChunks)
-        result.push_back(pair.second.get());
+    result.reserve(loadedChunks.getChunkCount());
+    loadedChunks.forEach([&](const std::shared_ptr<Chunk>& chunk)
+                         { result.push_back(chunk.get()); });
     return result;
 }
 
-// Unload a chunk (save it to disk and remove it from memory)
+// Hand a chunk to the background writer and move it into the chunk cache. If the writer is backed
+// up, the chunk stays loaded as UNLOADING and processChunkUploads retries it on a later frame.
+// Clean chunks are not saved; they are regenerated or reloaded the same when needed again.
 void ChunkManager::unloadChunk(int chunkX, int chunkZ)
 {
-    auto key = std::make_pair(chunkX, chunkZ);
+    const std::shared_ptr<Chunk>& chunk = loadedChunks.get(chunkX, chunkZ);
+    if (!chunk)
+        return;
 
-    auto it = loadedChunks.find(key);
-    if (it != loadedChunks.end())
+    if (chunk->isDirty() && !chunkWriter.tryEnqueue(chunk))
     {
-        it->second->deleteMesh();
+        auto key = std::make_pair(chunkX, chunkZ);
+        if (std::find(deferredUnloads.begin(), deferredUnloads.end(), key) == deferredUnloads.end())
+            deferredUnloads.push_back(key);
+
+        std::lock_guard<std::mutex> lock(loadMutex);
+        setChunkState(key, ChunkState::UNLOADING);
+        return;
+    }
+
+    retireChunk(loadedChunks.remove(chunkX, chunkZ));
+}
+
+// Removes a chunk that has to leave the grid right away. A dirty one the writer has no room for
+// stays UNLOADING in displacedChunks until processChunkUploads can queue it.
+void ChunkManager::forceUnload(std::shared_ptr<Chunk> chunk)
+{
+    auto key = std::make_pair(chunk->getX(), chunk->getZ());
+    deferredUnloads.erase(std::remove(deferredUnloads.begin(), deferredUnloads.end(), key),
+                          deferredUnloads.end());
 
-        RegionFile* region = getRegionFile(chunkX, chunkZ);
-        region->saveChunk(*(it->second));
-        loadedChunks.erase(it);
+    if (chunk->isDirty() && !chunkWriter.tryEnqueue(chunk))
+    {
+        {
+            std::lock_guard<std::mutex> lock(loadMutex);
+            setChunkState(key, ChunkState::UNLOADING);
+        }
+        displacedChunks.push_back(std::move(chunk));
+        return;
     }
+    retireChunk(std::move(chunk));
 }
 
+// Frees the GPU mesh of a chunk that is saved or queued for saving and moves it into the cache
+void ChunkManager::retireChunk(std::shared_ptr<Chunk> chunk)
+{
+    auto key = std::make_pair(chunk->getX(), chunk->getZ());
+
+    if (cacheMeshes)
+        chunk->releaseGPUMesh();
+    else
+        chunk->deleteMesh();
+    chunkCache.insert(std::move(chunk));
+
+    std::lock_guard<std::mutex> lock(loadMutex);
+    clearChunkState(key);
+}
+
+// Queues every dirty loaded chunk for saving and waits until all of them and their region headers
+// are on disk
 void ChunkManager::unloadAllChunks()
 {
-    for (auto& pair : loadedChunks)
+    loadedChunks.forEach(
+        [&](const std::shared_ptr<Chunk>& chunk)
+        {
+            chunk->deleteMesh();
+            if (chunk->isDirty())
+                chunkWriter.enqueue(chunk);
+        });
+    for (std::shared_ptr<Chunk>& chunk : displacedChunks)
+        chunkWriter.enqueue(std::move(chunk));
+    loadedChunks.clear();
+    deferredUnloads.clear();
+    displacedChunks.clear();
+    chunkCache.clear();
+    chunkWriter.flush();
+
     {
-        pair.second->deleteMesh();
+        std::lock_guard<std::mutex> lock(regionFilesMutex);
+        for (auto& pair : regionFiles)
+            pair.second->flush();
+    }
 
-        int         chunkX = pair.first.first;
-        int         chunkZ = pair.first.second;
-        RegionFile* region = getRegionFile(chunkX, chunkZ);
-        region->saveChunk(*(pair.second));
+    // Loads still in the pipeline keep their states
+    std::lock_guard<std::mutex> lock(loadMutex);
+    for (auto it = chunkStates.begin(); it != chunkStates.end();)
+    {
+        if (it->second == ChunkState::UPLOADED || it->second == ChunkState::UNLOADING)
+        {
+            --chunkStateCounts[static_cast<size_t>(it->second)];
+            it = chunkStates.erase(it);
+        }
+        else
+            ++it;
     }
-    loadedChunks.clear();
 }
 
-void ChunkManager::updateChunksAroundPlayer(float playerX, float playerZ, int renderRadius)
+void ChunkManager::updateChunksAroundPlayer(float playerX, float playerZ, int renderRadius,
+                                            glm::vec2 viewDirection)
 {
     int playerChunkX = static_cast<int>(std::floor(playerX / Chunk::WIDTH));
     int playerChunkZ = static_cast<int>(std::floor(playerZ / Chunk::DEPTH));
 
+    // Rescore pending loads around the new position and cancel the ones now out of range
+    {
+        std::lock_guard<std::mutex> lock(loadMutex);
+        loadCenterX       = playerChunkX;
+        loadCenterZ       = playerChunkZ;
+        loadRadius        = renderRadius;
+        loadViewDirection = glm::length(viewDirection) > 0.0f ? glm::normalize(viewDirection)
+                                                              : glm::vec2(0.0f);
+
+        auto outOfRange = [&](const LoadRequest& request)
+        {
+            if (std::abs(request.chunkX - playerChunkX) <= renderRadius &&
+                std::abs(request.chunkZ - playerChunkZ) <= renderRadius)
+                return false;
+            clearChunkState({request.chunkX, request.chunkZ});
+            return true;
+        };
+        loadQueue.erase(std::remove_if(loadQueue.begin(), loadQueue.end(), outOfRange),
+                        loadQueue.end());
+        for (LoadRequest& request : loadQueue)
+            request.priority = getLoadPriority(request.chunkX, request.chunkZ);
+        std::make_heap(loadQueue.begin(), loadQueue.end());
+    }
+
     for (int dx = -renderRadius; dx <= renderRadius; ++dx)
     {
         for (int dz = -renderRadius; dz <= renderRadius; ++dz)
-        {
-            int  chunkX = playerChunkX + dx;
-            int  chunkZ = playerChunkZ + dz;
-            auto key    = std::make_pair(chunkX, chunkZ);
-            if (loadedChunks.find(key) == loadedChunks.end())
-                enqueueChunkLoad(chunkX, chunkZ);
-        }
+            enqueueChunkLoad(playerChunkX + dx, playerChunkZ + dz);
     }
 
     std::vector<std::pair<int, int>> toUnload;
-    for (const auto& pair : loadedChunks)
-    {
-        int chunkX = pair.first.first;
-        int chunkZ = pair.first.second;
-        int dx     = chunkX - playerChunkX;
-        int dz     = chunkZ - playerChunkZ;
-        if (std::abs(dx) > renderRadius || std::abs(dz) > renderRadius)
+    loadedChunks.forEach(
+        [&](const std::shared_ptr<Chunk>& chunk)
         {
-            toUnload.emplace_back(chunkX, chunkZ);
-        }
-    }
+            if (!isInLoadRange(chunk->getX(), chunk->getZ()))
+                toUnload.emplace_back(chunk->getX(), chunk->getZ());
+        });
     for (const auto& key : toUnload)
     {
         unloadChunk(key.first, key.second);
     }
+
+    int gridSize = 2 * (renderRadius + gridMargin) + 1;
+    if (loadedChunks.getSize() != gridSize)
+    {
+        // Two in-range chunks never share a slot, so an out-of-range one is evicted from each clash
+        for (std::shared_ptr<Chunk>& displaced : loadedChunks.resize(gridSize))
+        {
+            if (isInLoadRange(displaced->getX(), displaced->getZ()))
+                displaced = loadedChunks.insert(std::move(displaced));
+            forceUnload(std::move(displaced));
+        }
+    }
 }
 
 void ChunkManager::processChunkUploads()
 {
+    std::queue<PendingChunk> arrived;
+    {
+        std::lock_guard<std::mutex> lock(readyMutex);
+        std::swap(arrived, readyChunks);
+    }
+
+    int centerX, centerZ, radius;
+    {
+        std::lock_guard<std::mutex> lock(loadMutex);
+        centerX = loadCenterX;
+        centerZ = loadCenterZ;
+        radius  = loadRadius;
+    }
+
+    // Retry unloads the writer had no room for, unless the player has come back for them
+    std::vector<std::pair<int, int>> retryUnloads;
+    std::swap(retryUnloads, deferredUnloads);
+    for (const auto& key : retryUnloads)
+    {
+        if (std::abs(key.first - centerX) <= radius && std::abs(key.second - centerZ) <= radius)
+        {
+            std::lock_guard<std::mutex> lock(loadMutex);
+            setChunkState(key, ChunkState::UPLOADED);
+        }
+        else
+            unloadChunk(key.first, key.second);
+    }
+
+    // Chunks pushed out of the grid go to the writer in order as it makes room
+    size_t queued = 0;
+    while (queued < displacedChunks.size() && chunkWriter.tryEnqueue(displacedChunks[queued]))
+        retireChunk(std::move(displacedChunks[queued++]));
+    displacedChunks.erase(displacedChunks.begin(), displacedChunks.begin() + queued);
+
+    // Mesh every new chunk, and remesh loaded neighbors whose border faces it now hides. Chunks
+    // that kept their mesh in the cache only need it checked against their new neighbors.
+    std::vector<std::pair<int, int>> toMesh, toRestore;
+    while (!arrived.empty())
+    {
+        PendingChunk& pending = arrived.front();
+        auto          key     = std::make_pair(pending.chunkX, pending.chunkZ);
+
+        // Loads that were already running when the player moved away are dropped unsaved
+        bool inRange = std::abs(key.first - centerX) <= radius &&
+                       std::abs(key.second - centerZ) <= radius;
+        if (!inRange)
+        {
+            std::lock_guard<std::mutex> lock(loadMutex);
+            clearChunkState(key);
+        }
+        else if (!loadedChunks.get(key.first, key.second))
+        {
+            {
+                std::lock_guard<std::mutex> lock(loadMutex);
+                setChunkState(key, ChunkState::UPLOADED);
+            }
+            (pending.chunk->meshGenerated ? toRestore : toMesh).push_back(key);
+            placeChunk(std::move(pending.chunk));
+
+            const std::pair<int, int> neighborKeys[4] = {{key.first - 1, key.second},
+                                                         {key.first + 1, key.second},
+                                                         {key.first, key.second - 1},
+                                                         {key.first, key.second + 1}};
+            for (const auto& neighborKey : neighborKeys)
+            {
+                if (loadedChunks.get(neighborKey.first, neighborKey.second))
+                    toMesh.push_back(neighborKey);
+            }
+        }
+        arrived.pop();
+    }
+
+    std::sort(toMesh.begin(), toMesh.end());
+    toMesh.erase(std::unique(toMesh.begin(), toMesh.end()), toMesh.end());
+    for (const auto& key : toMesh)
+    {
+        if (std::find(toRestore.begin(), toRestore.end(), key) == toRestore.end())
+            enqueueMesh(key.first, key.second);
+    }
+    for (const auto& key : toRestore)
+        restoreMesh(key.first, key.second);
+
     std::lock_guard<std::mutex> lock(readyMutex);
     int                         uploadsThisFrame   = 0;
     const int                   maxUploadsPerFrame = 2;
 
-    while (!readyChunks.empty() && uploadsThisFrame < maxUploadsPerFrame)
+    while (!meshedChunks.empty() && uploadsThisFrame < maxUploadsPerFrame)
     {
-        auto& pending = readyChunks.front();
-        pending.chunk->uploadMeshToGPU();
-        loadedChunks[{pending.chunkX, pending.chunkZ}] = std::move(pending.chunk);
-        readyChunks.pop();
-        ++uploadsThisFrame;
+        MeshResult& result = meshedChunks.front();
+
+        // Drop meshes for chunks that were unloaded or have a newer mesh job in flight
+        const std::shared_ptr<Chunk>& chunk =
+            loadedChunks.get(result.chunk->getX(), result.chunk->getZ());
+        if (chunk && chunk == result.chunk && chunk->meshRevision == result.revision)
+        {
+            chunk->setMesh(std::move(result.mesh));
+            chunk->uploadMeshToGPU(meshArena);
+            ++uploadsThisFrame;
+        }
+        meshedChunks.pop();
     }
 }
 
+// Joins the workers; queued loads and meshes that have not started are dropped
 void ChunkManager::stopWorker()
 {
-    stopWorkerThread = true;
-    queueCV.notify_all();
-    if (workerThread.joinable())
-        workerThread.join();
+    threadPool.shutdown();
+}
+
+// Applies to chunks meshed from now on; already loaded chunks keep their current mesh
+void ChunkManager::setMeshingMode(MeshingMode mode)
+{
+    meshingMode = mode;
+}
+
+void ChunkManager::setNoiseMode(NoiseMode mode)
+{
+    noiseMode = mode;
+}
+
+void ChunkManager::setNoiseCacheBudget(size_t megabytes)
+{
+    noiseGrids.setBudget(megabytes);
+}
+
+void ChunkManager::setCacheBudget(size_t megabytes)
+{
+    chunkCache.setBudget(megabytes);
+}
+
+// Applies to chunks unloaded from now on
+void ChunkManager::setCacheMeshes(bool keep)
+{
+    cacheMeshes = keep;
+}
+
+void ChunkManager::setTruncateRegionFiles(bool truncate)
+{
+    std::lock_guard<std::mutex> lock(regionFilesMutex);
+    truncateRegionFiles = truncate;
+    for (auto& pair : regionFiles)
+        pair.second->setTruncateOnClose(truncate);
+}
+
+void ChunkManager::setWorldDirectory(const std::string& path)
+{
+    std::lock_guard<std::mutex> lock(regionFilesMutex);
+    worldDirectory = path;
+}
+
+// Upload chunk meshes into a shared arena instead of per-chunk buffers; set before any chunk loads
+void ChunkManager::setMeshArena(ChunkMeshArena* arena)
+{
+    meshArena = arena;
 }
 
 // Helper to get or create a RegionFile for a given chunk
@@ -128,14 +387,17 @@ RegionFile* ChunkManager::getRegionFile(int chunkX, int chunkZ)
         return it->second.get();
 
     std::string filename = "r." + std::to_string(regionX) + "." + std::to_string(regionZ) + ".mca";
-    std::string path     = getRegionFilePath(filename);
+    std::string path     = worldDirectory.empty()
+                               ? getRegionFilePath(filename)
+                               : (std::filesystem::path(worldDirectory) / filename).string();
     auto        regionFile = std::make_unique<RegionFile>(path);
     RegionFile* ptr        = regionFile.get();
+    ptr->setTruncateOnClose(truncateRegionFiles);
     regionFiles[key]       = std::move(regionFile);
     return ptr;
 }
 
-void ChunkManager::deserializeChunk(Chunk& chunk, const std::vector<uint8_t>& data)
+void ChunkManager::deserializeChunk(Chunk& chunk, std::span<const uint8_t> data)
 {
     if (data.size() < 4)
     {
@@ -150,7 +412,11 @@ void ChunkManager::deserializeChunk(Chunk& chunk, const std::vector<uint8_t>& da
         throw std::invalid_argument("Invalid chunk data: not enough data for compressed length");
     }
 
-    std::vector<uint8_t> decompressedData(Chunk::WIDTH * Chunk::HEIGHT * Chunk::DEPTH);
+    // Legacy chunks store every block; sectioned chunks are at most this large
+    constexpr size_t legacySize = Chunk::WIDTH * Chunk::HEIGHT * Chunk::DEPTH;
+    constexpr size_t maxSize    = 3 + Chunk::SECTION_COUNT * (1 + ChunkSection::VOLUME);
+
+    std::vector<uint8_t> decompressedData(maxSize);
     uLongf               decompressedSize = decompressedData.size();
 
     int result = uncompress(decompressedData.data(), &decompressedSize, data.data() + 4,
@@ -161,103 +427,336 @@ void ChunkManager::deserializeChunk(Chunk& chunk, const std::vector<uint8_t>& da
         throw std::runtime_error("Failed to decompress chunk data");
     }
 
-    if (decompressedSize != decompressedData.size())
+    auto validateIds = [](const uint8_t* ids, size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (ids[i] >= BlockRegistry::COUNT)
+                throw std::runtime_error("Invalid block id in chunk data");
+        }
+    };
+
+    if (decompressedSize == legacySize)
+    {
+        // Legacy layout is y-major, so each section is a contiguous 16^3 run
+        validateIds(decompressedData.data(), legacySize);
+        for (int i = 0; i < Chunk::SECTION_COUNT; ++i)
+            chunk.getSection(i).setData(decompressedData.data() + i * ChunkSection::VOLUME);
+        return;
+    }
+
+    if (decompressedSize < 3 || decompressedData[0] != Chunk::FORMAT_VERSION)
     {
-        throw std::runtime_error("Decompressed data size does not match expected size");
+        throw std::runtime_error("Unsupported chunk data format");
     }
 
-    size_t i = 0;
-    for (int y = 0; y < Chunk::HEIGHT; ++y)
+    uint16_t sectionMask = (decompressedData[1] << 8) | decompressedData[2];
+    size_t   pos         = 3;
+
+    for (int i = 0; i < Chunk::SECTION_COUNT; ++i)
     {
-        for (int z = 0; z < Chunk::DEPTH; ++z)
+        // Sections missing from the mask are empty and stay as air
+        if (!(sectionMask & (1 << i)))
+            continue;
+
+        if (pos >= decompressedSize)
+            throw std::runtime_error("Invalid chunk data: truncated section");
+
+        ChunkSection& section = chunk.getSection(i);
+        uint8_t       tag     = decompressedData[pos++];
+        if (tag == Chunk::SECTION_UNIFORM && pos + 1 <= decompressedSize)
         {
-            for (int x = 0; x < Chunk::WIDTH; ++x)
-            {
-                Block::Id blockId = static_cast<Block::Id>(decompressedData[i++]);
-                chunk.setBlock(x, y, z, Block(blockId));
-            }
+            validateIds(decompressedData.data() + pos, 1);
+            section.fill(static_cast<Block::Id>(decompressedData[pos]));
+            pos += 1;
+        }
+        else if (tag == Chunk::SECTION_FULL && pos + ChunkSection::VOLUME <= decompressedSize)
+        {
+            validateIds(decompressedData.data() + pos, ChunkSection::VOLUME);
+            section.setData(decompressedData.data() + pos);
+            pos += ChunkSection::VOLUME;
+        }
+        else
+        {
+            throw std::runtime_error("Invalid chunk data: bad section storage");
         }
     }
 }
 
-void ChunkManager::workerFunc()
+size_t ChunkManager::getChunkCount(ChunkState state) const
+{
+    std::lock_guard<std::mutex> lock(loadMutex);
+    return chunkStateCounts[static_cast<size_t>(state)];
+}
+
+// Callers hold loadMutex
+void ChunkManager::setChunkState(const std::pair<int, int>& key, ChunkState state)
+{
+    auto [it, inserted] = chunkStates.try_emplace(key, state);
+    if (!inserted)
+    {
+        --chunkStateCounts[static_cast<size_t>(it->second)];
+        it->second = state;
+    }
+    ++chunkStateCounts[static_cast<size_t>(state)];
+}
+
+// Callers hold loadMutex
+void ChunkManager::clearChunkState(const std::pair<int, int>& key)
+{
+    auto it = chunkStates.find(key);
+    if (it == chunkStates.end())
+        return;
+
+    --chunkStateCounts[static_cast<size_t>(it->second)];
+    chunkStates.erase(it);
+}
+
+// Distance in chunks from the last update center, reduced for chunks in front of the camera.
+// Callers hold loadMutex.
+float ChunkManager::getLoadPriority(int chunkX, int chunkZ) const
+{
+    glm::vec2 offset(chunkX - loadCenterX, chunkZ - loadCenterZ);
+    float     distance = glm::length(offset);
+    if (distance == 0.0f)
+        return -viewDirectionBias;
+
+    float facing = glm::dot(offset / distance, loadViewDirection);
+    return distance - viewDirectionBias * facing;
+}
+
+// Each submitted load task takes whichever request is best when it runs, not the one that was
+// queued alongside it, so rescoring in updateChunksAroundPlayer affects work already submitted
+void ChunkManager::loadNextChunk()
+{
+    LoadRequest request;
+    {
+        std::lock_guard<std::mutex> lock(loadMutex);
+        if (loadQueue.empty())
+            return;  // Its request was cancelled
+
+        std::pop_heap(loadQueue.begin(), loadQueue.end());
+        request = loadQueue.back();
+        loadQueue.pop_back();
+        setChunkState({request.chunkX, request.chunkZ}, ChunkState::LOADING);
+    }
+    loadChunk(request.chunkX, request.chunkZ);
+}
+
+// Load a chunk from its region file, or hand it to a generation task if it was never saved.
+// Meshing happens once the chunk reaches the main thread.
+void ChunkManager::loadChunk(int chunkX, int chunkZ)
+{
+    // A chunk still waiting to be saved is newer than the copy in its region file
+    if (auto pending = chunkWriter.findPending(chunkX, chunkZ))
+    {
+        pushReadyChunk(chunkX, chunkZ, std::move(pending));
+        return;
+    }
+
+    // Decompression reads straight from the mapped region file
+    RegionFile*      region = getRegionFile(chunkX, chunkZ);
+    MappedFile::View data   = region->loadChunk(chunkX, chunkZ);
+    if (data.bytes.empty())
+    {
+        threadPool.submit([this, chunkX, chunkZ] { generateChunk(chunkX, chunkZ); });
+        return;
+    }
+
+    auto chunk = std::make_shared<Chunk>(chunkX, chunkZ);
+    deserializeChunk(*chunk, data.bytes);
+    pushReadyChunk(chunkX, chunkZ, std::move(chunk));
+}
+
+void ChunkManager::generateChunk(int chunkX, int chunkZ)
 {
-    while (!stopWorkerThread)
+    auto chunk   = std::make_shared<Chunk>(chunkX, chunkZ);
+    int  regionX = static_cast<int>(std::floor(static_cast<double>(chunkX) / REGION_SIZE));
+    int  regionZ = static_cast<int>(std::floor(static_cast<double>(chunkZ) / REGION_SIZE));
+
+    // Every chunk of the region shares these grids, generated once. In CHUNK mode missing grids
+    // are left to a background task rather than waited for.
+    std::shared_ptr<const RegionNoiseGrids> grids;
+    if (noiseMode == NoiseMode::CHUNK)
     {
-        std::pair<int, int> request;
+        NoiseGridCache::Lookup lookup = noiseGrids.find(regionX, regionZ, noiseSeed);
+        if (lookup.created)
         {
-            std::unique_lock<std::mutex> lock(queueMutex);
-            queueCV.wait(lock, [&] { return !chunkLoadQueue.empty() || stopWorkerThread; });
-            if (stopWorkerThread)
-                break;
-            request = chunkLoadQueue.front();
-            chunkLoadQueue.pop();
+            threadPool.submit([this, regionX, regionZ]
+                              { noiseGrids.get(regionX, regionZ, noiseSeed); });
         }
+        grids = std::move(lookup.grids);
+    }
+    else
+    {
+        grids = noiseGrids.get(regionX, regionZ, noiseSeed);
+    }
 
-        int chunkX = request.first;
-        int chunkZ = request.second;
+    // Position of the chunk's first block within the grids
+    int gridSize = NOISE_GRID_SIZE;
+    int originX  = (chunkX & (REGION_SIZE - 1)) * Chunk::WIDTH;
+    int originZ  = (chunkZ & (REGION_SIZE - 1)) * Chunk::DEPTH;
 
-        RegionFile* region = getRegionFile(chunkX, chunkZ);
-        auto        data   = region->loadChunk(chunkX, chunkZ);
-        auto        chunk  = std::make_unique<Chunk>(chunkX, chunkZ);
-        if (!data.empty())
-            deserializeChunk(*chunk, data);
-        else
+    if (!grids)
+    {
+        // Region grids not ready yet: sample just this chunk, on the same lattice
+        auto chunkGrids = std::make_shared<RegionNoiseGrids>();
+        worldGenerator.generateChunkNoiseGrids(chunkGrids->channels, chunkX, chunkZ,
+                                               noiseFrequency, noiseSeed);
+        grids    = std::move(chunkGrids);
+        gridSize = CHUNK_NOISE_GRID_SIZE;
+        originX  = 0;
+        originZ  = 0;
+    }
+
+    std::array<float, CHUNK_SIZE * CHUNK_SIZE> heights;
+    worldGenerator.generateHeights(grids->channels, gridSize, originX, originZ, heights);
+
+    for (int x = 0; x < Chunk::WIDTH; ++x)
+    {
+        for (int z = 0; z < Chunk::DEPTH; ++z)
         {
-            int regionX = static_cast<int>(std::floor(static_cast<double>(chunkX) / REGION_SIZE));
-            int regionZ = static_cast<int>(std::floor(static_cast<double>(chunkZ) / REGION_SIZE));
-            region->generateNoiseGrids(worldGenerator, regionX, regionZ, 0.01f,
-                                       0);  // Temp frequency and seed
+            int blockY = static_cast<int>(heights[z * CHUNK_SIZE + x]);
 
-            for (int x = 0; x < Chunk::WIDTH; ++x)
+            for (int y = 0; y < blockY && y < Chunk::HEIGHT; ++y)
             {
-                for (int z = 0; z < Chunk::DEPTH; ++z)
-                {
-                    // TODO: make below more clear (move into WorldGenerator)
-                    int regionBlockX = x + (chunkX & (REGION_SIZE - 1)) * Chunk::WIDTH;
-                    int regionBlockZ = z + (chunkZ & (REGION_SIZE - 1)) * Chunk::DEPTH;
-
-                    // clang-format off
-                    float continentNoise = worldGenerator.getInterpolatedNoise(
-                        region->continentGrid, regionBlockX, regionBlockZ);
-                    float erosionNoise = worldGenerator.getInterpolatedNoise(
-                        region->erosionGrid, regionBlockX, regionBlockZ);
-                    float pvNoise = worldGenerator.getInterpolatedNoise(
-                        region->pvGrid, regionBlockX, regionBlockZ);
-                    // clang-format on
-
-                    float continentVal = worldGenerator.continentSpline.evaluate(continentNoise);
-                    float erosionVal   = worldGenerator.erosionSpline.evaluate(erosionNoise);
-                    float pvVal        = worldGenerator.pvSpline.evaluate(pvNoise);
-
-                    // float targetHeight = continentVal * erosionVal + pvVal * 10.0f;
-                    float targetHeight = continentVal;
-                    int   blockY       = static_cast<int>(targetHeight);
-
-                    for (int y = 0; y < blockY && y < Chunk::HEIGHT; ++y)
-                    {
-                        Block::Id id = Block::Id::DIRT;
-                        if (y == blockY - 1)
-                            id = Block::Id::GRASS;
-                        if (y < blockY - 5)
-                            id = Block::Id::STONE;
-                        chunk->setBlock(x, y, z, Block(id));
-                    }
-                }
+                Block::Id id = Block::Id::DIRT;
+                if (y == blockY - 1)
+                    id = Block::Id::GRASS;
+                if (y < blockY - 5)
+                    id = Block::Id::STONE;
+                chunk->setBlock(x, y, z, Block(id));
             }
         }
-        chunk->generateMesh();
+    }
+    chunk->compactSections();
+    chunk->clearDirty();  // The seed reproduces it
 
-        {
-            std::lock_guard<std::mutex> lock(readyMutex);
-            readyChunks.push({chunkX, chunkZ, std::move(chunk)});
-        }
+    pushReadyChunk(chunkX, chunkZ, std::move(chunk));
+}
+
+void ChunkManager::meshChunk(const MeshJob& job)
+{
+    ChunkMesh mesh = job.cachedMesh
+                         ? job.chunk->remeshBorders(*job.cachedMesh, *job.neighbors, meshingMode)
+                         : job.chunk->generateMesh(*job.neighbors, meshingMode);
+    mesh.neighbors = job.neighbors;
+
+    std::lock_guard<std::mutex> lock(readyMutex);
+    meshedChunks.push({job.chunk, job.revision, std::move(mesh)});
+}
+
+void ChunkManager::pushReadyChunk(int chunkX, int chunkZ, std::shared_ptr<Chunk> chunk)
+{
+    {
+        std::lock_guard<std::mutex> lock(loadMutex);
+        setChunkState({chunkX, chunkZ}, ChunkState::READY);
     }
+
+    std::lock_guard<std::mutex> lock(readyMutex);
+    readyChunks.push({chunkX, chunkZ, std::move(chunk)});
+}
+
+bool ChunkManager::isInLoadRange(int chunkX, int chunkZ) const
+{
+    std::lock_guard<std::mutex> lock(loadMutex);
+    return std::abs(chunkX - loadCenterX) <= loadRadius &&
+           std::abs(chunkZ - loadCenterZ) <= loadRadius;
 }
 
+// Puts an in-range chunk into the grid. Anything sharing its slot is out of range with its unload
+// deferred, so it leaves the grid now and is saved as soon as the writer has room.
+void ChunkManager::placeChunk(std::shared_ptr<Chunk> chunk)
+{
+    if (auto displaced = loadedChunks.insert(std::move(chunk)))
+        forceUnload(std::move(displaced));
+}
+
+// Does nothing if the coordinate is already queued, in flight or loaded
 void ChunkManager::enqueueChunkLoad(int chunkX, int chunkZ)
 {
-    std::lock_guard<std::mutex> lock(queueMutex);
-    chunkLoadQueue.emplace(chunkX, chunkZ);
-    queueCV.notify_one();
+    {
+        std::lock_guard<std::mutex> lock(loadMutex);
+        if (chunkStates.find({chunkX, chunkZ}) != chunkStates.end())
+            return;
+    }
+
+    // Cache hits skip the load queue and reach the world on the next processChunkUploads
+    if (auto cached = chunkCache.take(chunkX, chunkZ))
+    {
+        pushReadyChunk(chunkX, chunkZ, std::move(cached));
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(loadMutex);
+        setChunkState({chunkX, chunkZ}, ChunkState::QUEUED);
+        loadQueue.push_back({chunkX, chunkZ, getLoadPriority(chunkX, chunkZ)});
+        std::push_heap(loadQueue.begin(), loadQueue.end());
+    }
+    threadPool.submit([this] { loadNextChunk(); });
+}
+
+// Snapshot the neighbor borders and hand the chunk to the pool for meshing
+void ChunkManager::enqueueMesh(int chunkX, int chunkZ)
+{
+    const std::shared_ptr<Chunk>& chunk = loadedChunks.get(chunkX, chunkZ);
+    if (!chunk)
+        return;
+
+    MeshJob job;
+    job.chunk     = chunk;
+    job.neighbors = captureNeighborhood(chunkX, chunkZ);
+    job.revision  = ++chunk->meshRevision;
+
+    threadPool.submit([this, job = std::move(job)] { meshChunk(job); });
+}
+
+// Brings back the mesh a chunk kept in the cache. If its neighbor borders are unchanged it goes
+// straight into the upload queue; otherwise only the faces against the changed borders are rebuilt.
+// Either way the chunk has no mesh until the result is uploaded, so a chunk unloaded again before
+// then is fully remeshed next time.
+void ChunkManager::restoreMesh(int chunkX, int chunkZ)
+{
+    const std::shared_ptr<Chunk>& chunk = loadedChunks.get(chunkX, chunkZ);
+    if (!chunk)
+        return;
+
+    MeshJob job;
+    job.chunk      = chunk;
+    job.neighbors  = captureNeighborhood(chunkX, chunkZ);
+    job.revision   = ++chunk->meshRevision;
+    job.cachedMesh = std::move(chunk->mesh);
+    chunk->deleteMesh();
+
+    const ChunkMesh& cached    = *job.cachedMesh;
+    bool             unchanged = cached.neighbors != nullptr;
+    for (Direction side : {Direction::LEFT, Direction::RIGHT, Direction::BACK, Direction::FRONT})
+        unchanged = unchanged && job.neighbors->hasSameBorder(*cached.neighbors, side);
+
+    if (unchanged)
+    {
+        std::lock_guard<std::mutex> lock(readyMutex);
+        meshedChunks.push({job.chunk, job.revision, std::move(*job.cachedMesh)});
+        return;
+    }
+    threadPool.submit([this, job = std::move(job)] { meshChunk(job); });
+}
+
+std::shared_ptr<const ChunkNeighborhood> ChunkManager::captureNeighborhood(int chunkX,
+                                                                           int chunkZ) const
+{
+    auto neighborhood = std::make_shared<ChunkNeighborhood>();
+
+    const std::pair<Direction, std::pair<int, int>> neighbors[4] = {
+        {Direction::LEFT, {chunkX - 1, chunkZ}},
+        {Direction::RIGHT, {chunkX + 1, chunkZ}},
+        {Direction::BACK, {chunkX, chunkZ - 1}},
+        {Direction::FRONT, {chunkX, chunkZ + 1}}};
+    for (const auto& [side, key] : neighbors)
+    {
+        if (const std::shared_ptr<Chunk>& neighbor = loadedChunks.get(key.first, key.second))
+            neighborhood->captureNeighbor(side, *neighbor);
+    }
+    return neighborhood;
 }
@@ -1,23 +1,53 @@
 #pragma once
 
 #include "chunk.h"
+#include "chunk_cache.h"
+#include "chunk_grid.h"
+#include "chunk_neighborhood.h"
+#include "chunk_writer.h"
+#include "noise_grid_cache.h"
 #include "region_file.h"
+#include "thread_pool.h"
 #include "world_generator.h"
 
+#include <glm/glm.hpp>
+
 #include <unordered_map>
 #include <memory>
+#include <optional>
+#include <span>
+#include <string>
 #include <utility>
 #include <vector>
+#include <array>
 #include <queue>
-#include <thread>
 #include <mutex>
 #include <atomic>
-#include <condition_variable>
+
+// Where a chunk coordinate is in the load pipeline; coordinates with no state are not loaded
+enum class ChunkState : uint8_t
+{
+    QUEUED,     // Waiting in the load queue
+    LOADING,    // Being read or generated by a worker
+    READY,      // Loaded, waiting for the main thread to pick it up
+    UPLOADED,   // In the loaded chunk grid; its mesh is on the GPU or being built
+    UNLOADING,  // Being saved and removed
+    COUNT
+};
+
+// Where terrain generation takes its noise samples from
+enum class NoiseMode : uint8_t
+{
+    REGION,  // Region-wide grids; the first chunk of a region waits until they are generated
+    CHUNK,   // Only the samples a chunk covers until the region grids, filled in the background,
+             // are ready
+};
 
 class ChunkManager
 {
    public:
-    ChunkManager(WorldGenerator& generator);
+    // A worker count of 0 sizes the pool from the hardware thread count
+    ChunkManager(WorldGenerator& generator, size_t workerCount = 0);
     ~ChunkManager();
 
     // Custom hash for std::pair<int, int>
@@ -32,34 +62,135 @@ class ChunkManager
     std::vector<Chunk*> getLoadedChunks() const;
     void                unloadChunk(int chunkX, int chunkZ);
     void                unloadAllChunks();
-    void                updateChunksAroundPlayer(float playerX, float playerZ, int renderRadius);
     void                processChunkUploads();
     void                stopWorker();
+    void                setMeshingMode(MeshingMode mode);
+    void                setMeshArena(ChunkMeshArena* arena);
+
+    // Recently unloaded chunks are kept up to this budget; with cacheMeshes their CPU meshes too,
+    // which are reused as long as their neighbors' borders are unchanged and otherwise rebuilt
+    // only along the changed sides
+    void              setCacheBudget(size_t megabytes);
+    void              setCacheMeshes(bool keep);
+    const ChunkCache& getChunkCache() const
+    {
+        return chunkCache;
+    }
+
+    // Region noise grids are kept up to this budget, separately from region files
+    void                  setNoiseMode(NoiseMode mode);
+    void                  setNoiseCacheBudget(size_t megabytes);
+    const NoiseGridCache& getNoiseGridCache() const
+    {
+        return noiseGrids;
+    }
+
+    // Shrink region files by their trailing free sectors when they are closed
+    void setTruncateRegionFiles(bool truncate);
+    // Region files are kept in the world folder next to the executable unless set otherwise;
+    // set before any chunk loads
+    void setWorldDirectory(const std::string& path);
+
+    // Loads start closest to the player first, favoring chunks along the horizontal view direction.
+    // Coordinates that already have a state are not requested again.
+    void updateChunksAroundPlayer(float playerX, float playerZ, int renderRadius,
+                                  glm::vec2 viewDirection = glm::vec2(0.0f));
+
+    // Number of coordinates currently in the given state
+    size_t getChunkCount(ChunkState state) const;
+    // Unloaded chunks not yet written to their region file
+    size_t getPendingWriteCount() const
+    {
+        return chunkWriter.getPendingCount() + displacedChunks.size();
+    }
 
    private:
     WorldGenerator& worldGenerator;
+    ChunkMeshArena* meshArena = nullptr;
+    NoiseGridCache  noiseGrids;
+
+    ChunkGrid loadedChunks;  // Main thread only
 
-    std::unordered_map<std::pair<int, int>, std::unique_ptr<Chunk>, pair_hash>      loadedChunks;
     std::unordered_map<std::pair<int, int>, std::unique_ptr<RegionFile>, pair_hash> regionFiles;
-    std::mutex regionFilesMutex;
+    std::mutex  regionFilesMutex;
+    bool        truncateRegionFiles = false;
+    std::string worldDirectory;  // Empty for the default world folder
+
+    ChunkWriter                         chunkWriter;
+    std::vector<std::pair<int, int>>    deferredUnloads;  // Waiting for room in the write queue
+    std::vector<std::shared_ptr<Chunk>> displacedChunks;  // Out of the grid, likewise waiting
+    ChunkCache                          chunkCache;
+    bool                                cacheMeshes = false;
 
     RegionFile* getRegionFile(int chunkX, int chunkZ);
-    void        deserializeChunk(Chunk& chunk, const std::vector<uint8_t>& data);
+    void        deserializeChunk(Chunk& chunk, std::span<const uint8_t> data);
 
-    std::queue<std::pair<int, int>> chunkLoadQueue;
-    std::mutex                      queueMutex;
-    std::condition_variable         queueCV;
-    std::thread                     workerThread;
-    std::atomic<bool>               stopWorkerThread{false};
+    struct MeshJob
+    {
+        std::shared_ptr<const Chunk>             chunk;
+        std::shared_ptr<const ChunkNeighborhood> neighbors;
+        uint32_t                                 revision;
+        std::optional<ChunkMesh>                 cachedMesh;  // Only its borders are rebuilt
+    };
+
+    struct MeshResult
+    {
+        std::shared_ptr<const Chunk> chunk;
+        uint32_t                     revision;
+        ChunkMesh                    mesh;
+    };
+
+    std::atomic<MeshingMode> meshingMode{MeshingMode::GREEDY};
+    std::atomic<NoiseMode>   noiseMode{NoiseMode::REGION};
+
+    struct LoadRequest
+    {
+        int   chunkX, chunkZ;
+        float priority;  // Lower loads first
+
+        bool operator<(const LoadRequest& other) const
+        {
+            return priority > other.priority;  // Max-heap order puts the lowest priority on top
+        }
+    };
+
+    // Pending loads as a heap, scored against the player position from the last update.
+    // loadMutex also guards the per-coordinate states.
+    std::vector<LoadRequest> loadQueue;
+    mutable std::mutex       loadMutex;
+    int                      loadCenterX = 0, loadCenterZ = 0, loadRadius = 0;
+    glm::vec2                loadViewDirection{0.0f};
+
+    std::unordered_map<std::pair<int, int>, ChunkState, pair_hash> chunkStates;
+    std::array<size_t, static_cast<size_t>(ChunkState::COUNT)>     chunkStateCounts{};
 
     struct PendingChunk
     {
         int                    chunkX, chunkZ;
-        std::unique_ptr<Chunk> chunk;
+        std::shared_ptr<Chunk> chunk;
     };
     std::queue<PendingChunk> readyChunks;
+    std::queue<MeshResult>   meshedChunks;
     std::mutex               readyMutex;
 
-    void workerFunc();
-    void enqueueChunkLoad(int chunkX, int chunkZ);
+    // Declared last so it is constructed after everything its tasks touch
+    ThreadPool threadPool;
+
+    void  setChunkState(const std::pair<int, int>& key, ChunkState state);
+    void  clearChunkState(const std::pair<int, int>& key);
+    float getLoadPriority(int chunkX, int chunkZ) const;
+    void  loadNextChunk();
+    void  loadChunk(int chunkX, int chunkZ);
+    void  generateChunk(int chunkX, int chunkZ);
+    void  meshChunk(const MeshJob& job);
+    void  pushReadyChunk(int chunkX, int chunkZ, std::shared_ptr<Chunk> chunk);
+    void  enqueueChunkLoad(int chunkX, int chunkZ);
+    bool  isInLoadRange(int chunkX, int chunkZ) const;
+    void  placeChunk(std::shared_ptr<Chunk> chunk);
+    void  forceUnload(std::shared_ptr<Chunk> chunk);
+    void  retireChunk(std::shared_ptr<Chunk> chunk);
+    void  enqueueMesh(int chunkX, int chunkZ);
+    void  restoreMesh(int chunkX, int chunkZ);
+
+    std::shared_ptr<const ChunkNeighborhood> captureNeighborhood(int chunkX, int chunkZ) const;
 };
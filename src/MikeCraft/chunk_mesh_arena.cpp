@@ -0,0 +1,159 @@
+#include "chunk_mesh_arena.h"
+
+#include <algorithm>
+
+ChunkMeshArena::ChunkMeshArena(uint32_t initialCapacity) : capacity(initialCapacity)
+{
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(capacity) * sizeof(GLuint), nullptr,
+                 GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    freeBlocks[0] = capacity;
+}
+
+ChunkMeshArena::~ChunkMeshArena()
+{
+    if (buffer != 0)
+        glDeleteBuffers(1, &buffer);
+}
+
+ChunkMeshArena::Handle ChunkMeshArena::upload(const std::vector<GLuint>& vertices)
+{
+    if (vertices.empty())
+        return INVALID_HANDLE;
+
+    uint32_t size   = static_cast<uint32_t>(vertices.size());
+    auto     offset = allocate(size);
+    if (!offset)
+    {
+        // Compact if there is enough free space in total, otherwise grow
+        if (capacity - usedVertices >= size)
+            defragment();
+        else
+            relocate(std::max(capacity * 2, usedVertices + size));
+        offset = allocate(size);
+    }
+
+    Handle handle;
+    if (!freeHandles.empty())
+    {
+        handle = freeHandles.back();
+        freeHandles.pop_back();
+    }
+    else
+    {
+        handle = static_cast<Handle>(allocations.size());
+        allocations.push_back({});
+    }
+    allocations[handle] = {*offset, size, true};
+    usedVertices += size;
+
+    glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    glBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>(*offset) * sizeof(GLuint),
+                    static_cast<GLsizeiptr>(size) * sizeof(GLuint), vertices.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    return handle;
+}
+
+void ChunkMeshArena::release(Handle handle)
+{
+    if (handle == INVALID_HANDLE || !allocations[handle].live)
+        return;
+
+    Allocation& allocation = allocations[handle];
+    addFreeBlock(allocation.offset, allocation.size);
+    usedVertices -= allocation.size;
+    allocation.live = false;
+    freeHandles.push_back(handle);
+}
+
+// Pack every live allocation to the front of a fresh buffer of the same size
+void ChunkMeshArena::defragment()
+{
+    relocate(capacity);
+}
+
+// First fit over the offset-ordered free list
+std::optional<uint32_t> ChunkMeshArena::allocate(uint32_t size)
+{
+    for (auto it = freeBlocks.begin(); it != freeBlocks.end(); ++it)
+    {
+        if (it->second < size)
+            continue;
+
+        uint32_t offset    = it->first;
+        uint32_t remaining = it->second - size;
+        freeBlocks.erase(it);
+        if (remaining > 0)
+            freeBlocks[offset + size] = remaining;
+        return offset;
+    }
+    return std::nullopt;
+}
+
+// Insert a free block, merging it with the free blocks directly before and after it
+void ChunkMeshArena::addFreeBlock(uint32_t offset, uint32_t size)
+{
+    auto next = freeBlocks.lower_bound(offset);
+    if (next != freeBlocks.end() && offset + size == next->first)
+    {
+        size += next->second;
+        next = freeBlocks.erase(next);
+    }
+    if (next != freeBlocks.begin())
+    {
+        auto prev = std::prev(next);
+        if (prev->first + prev->second == offset)
+        {
+            prev->second += size;
+            return;
+        }
+    }
+    freeBlocks[offset] = size;
+}
+
+// Copy all live allocations, in offset order, into a new buffer of newCapacity vertices
+void ChunkMeshArena::relocate(uint32_t newCapacity)
+{
+    std::vector<Handle> live;
+    for (Handle handle = 0; handle < allocations.size(); ++handle)
+    {
+        if (allocations[handle].live)
+            live.push_back(handle);
+    }
+    std::sort(live.begin(), live.end(), [this](Handle a, Handle b)
+              { return allocations[a].offset < allocations[b].offset; });
+
+    GLuint newBuffer;
+    glGenBuffers(1, &newBuffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, newBuffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(newCapacity) * sizeof(GLuint),
+                 nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+
+    uint32_t cursor = 0;
+    for (Handle handle : live)
+    {
+        Allocation& allocation = allocations[handle];
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+                            static_cast<GLintptr>(allocation.offset) * sizeof(GLuint),
+                            static_cast<GLintptr>(cursor) * sizeof(GLuint),
+                            static_cast<GLsizeiptr>(allocation.size) * sizeof(GLuint));
+        allocation.offset = cursor;
+        cursor += allocation.size;
+    }
+
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    glDeleteBuffers(1, &buffer);
+
+    buffer   = newBuffer;
+    capacity = newCapacity;
+    ++generation;
+    freeBlocks.clear();
+    if (cursor < capacity)
+        freeBlocks[cursor] = capacity - cursor;
+}
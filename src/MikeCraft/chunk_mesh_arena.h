@@ -0,0 +1,73 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <vector>
+
+// One large GPU vertex buffer shared by all chunk meshes. Meshes are suballocated from a free list
+// and compacted into a fresh buffer when the free space becomes too fragmented or runs out.
+class ChunkMeshArena
+{
+   public:
+    using Handle                           = uint32_t;
+    static constexpr Handle INVALID_HANDLE = UINT32_MAX;
+
+    explicit ChunkMeshArena(uint32_t initialCapacity);  // Capacity in vertices
+    ~ChunkMeshArena();
+
+    ChunkMeshArena(const ChunkMeshArena&)            = delete;
+    ChunkMeshArena& operator=(const ChunkMeshArena&) = delete;
+
+    // Returns INVALID_HANDLE for empty meshes
+    Handle upload(const std::vector<GLuint>& vertices);
+    void   release(Handle handle);
+
+    GLint getBaseVertex(Handle handle) const
+    {
+        return static_cast<GLint>(allocations[handle].offset);
+    }
+    GLuint getBuffer() const
+    {
+        return buffer;
+    }
+    // Changes whenever the buffer is replaced. Buffer names are reused once deleted, so compare
+    // this rather than getBuffer() to notice a relocation.
+    uint32_t getGeneration() const
+    {
+        return generation;
+    }
+    uint32_t getCapacity() const
+    {
+        return capacity;
+    }
+    uint32_t getUsedVertices() const
+    {
+        return usedVertices;
+    }
+
+    void defragment();
+
+   private:
+    struct Allocation
+    {
+        uint32_t offset;
+        uint32_t size;
+        bool     live;
+    };
+
+    GLuint   buffer       = 0;
+    uint32_t capacity     = 0;
+    uint32_t usedVertices = 0;
+    uint32_t generation   = 1;
+
+    std::vector<Allocation>      allocations;  // Indexed by handle
+    std::vector<Handle>          freeHandles;
+    std::map<uint32_t, uint32_t> freeBlocks;  // Offset -> size, in vertices
+
+    std::optional<uint32_t> allocate(uint32_t size);
+    void                    addFreeBlock(uint32_t offset, uint32_t size);
+    void                    relocate(uint32_t newCapacity);
+};
@@ -0,0 +1,52 @@
+#include "chunk_neighborhood.h"
+
+#include <stdexcept>
+
+void ChunkNeighborhood::captureNeighbor(Direction side, const Chunk& neighbor)
+{
+    // The neighbor layer touching this chunk: last column for LEFT/BACK, first for RIGHT/FRONT
+    int  fixed;
+    bool alongX;
+    switch (side)
+    {
+        case Direction::LEFT:
+            fixed  = Chunk::WIDTH - 1;
+            alongX = false;
+            break;
+        case Direction::RIGHT:
+            fixed  = 0;
+            alongX = false;
+            break;
+        case Direction::BACK:
+            fixed  = Chunk::DEPTH - 1;
+            alongX = true;
+            break;
+        case Direction::FRONT:
+            fixed  = 0;
+            alongX = true;
+            break;
+        default:
+            throw std::invalid_argument("Chunk neighbors are horizontal only");
+    }
+
+    auto& border = borders[static_cast<int>(side)];
+    border.reset();
+    for (int sectionIndex = 0; sectionIndex < Chunk::SECTION_COUNT; ++sectionIndex)
+    {
+        const ChunkSection& section = neighbor.getSection(sectionIndex);
+        if (section.isEmpty())
+            continue;
+
+        for (int ly = 0; ly < ChunkSection::SIZE; ++ly)
+        {
+            int y = sectionIndex * ChunkSection::SIZE + ly;
+            for (int along = 0; along < Chunk::WIDTH; ++along)
+            {
+                Block::Id id = alongX ? section.getBlock(along, ly, fixed)
+                                      : section.getBlock(fixed, ly, along);
+                border[along + y * Chunk::WIDTH] = BlockRegistry::isSolid(id);
+            }
+        }
+    }
+    present[static_cast<int>(side)] = true;
+}
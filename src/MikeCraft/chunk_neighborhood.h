@@ -0,0 +1,37 @@
+#pragma once
+
+#include "chunk.h"
+
+#include <array>
+#include <bitset>
+
+// Read-only snapshot of the solid blocks facing a chunk across each horizontal border. Built by
+// ChunkManager on the main thread so mesh jobs never touch the live neighbor chunks.
+class ChunkNeighborhood
+{
+   public:
+    void captureNeighbor(Direction side, const Chunk& neighbor);
+
+    bool hasNeighbor(Direction side) const
+    {
+        return present[static_cast<int>(side)];
+    }
+    // Missing neighbors match all-empty borders, since neither hides any face
+    bool hasSameBorder(const ChunkNeighborhood& other, Direction side) const
+    {
+        return borders[static_cast<int>(side)] == other.borders[static_cast<int>(side)];
+    }
+
+    // along is z for LEFT/RIGHT and x for BACK/FRONT; missing neighbors count as non-solid
+    bool isSolid(Direction side, int along, int y) const
+    {
+        return borders[static_cast<int>(side)][along + y * Chunk::WIDTH];
+    }
+
+   private:
+    static_assert(Chunk::WIDTH == Chunk::DEPTH);
+
+    // Indexed by Direction; TOP and BOTTOM are never set
+    std::array<std::bitset<Chunk::WIDTH * Chunk::HEIGHT>, 6> borders;
+    std::array<bool, 6>                                      present{};
+};
@@ -0,0 +1,52 @@
+#include "chunk_section.h"
+
+#include <algorithm>
+#include <cstring>
+
+void ChunkSection::setBlock(int x, int y, int z, Block::Id id)
+{
+    if (!blocks)
+    {
+        if (id == uniformId)
+            return;
+
+        blocks = std::make_unique<Block::Id[]>(VOLUME);
+        std::fill_n(blocks.get(), VOLUME, uniformId);
+    }
+    blocks[blockIndex(x, y, z)] = id;
+}
+
+void ChunkSection::fill(Block::Id id)
+{
+    blocks.reset();
+    uniformId = id;
+}
+
+void ChunkSection::setData(const uint8_t* rawIds)
+{
+    static_assert(sizeof(Block::Id) == 1);
+
+    if (!blocks)
+        blocks = std::make_unique<Block::Id[]>(VOLUME);
+    std::memcpy(blocks.get(), rawIds, VOLUME);
+    compact();
+}
+
+// Collapse the section back to a single id if every voxel holds the same block
+void ChunkSection::compact()
+{
+    if (!blocks)
+        return;
+
+    Block::Id first = blocks[0];
+    if (std::all_of(blocks.get() + 1, blocks.get() + VOLUME,
+                    [first](Block::Id id) { return id == first; }))
+    {
+        fill(first);
+    }
+}
+
+size_t ChunkSection::memoryUsage() const
+{
+    return sizeof(ChunkSection) + (blocks ? VOLUME * sizeof(Block::Id) : 0);
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "block.h"
+
+#include <memory>
+#include <cstdint>
+
+// A 16x16x16 slice of a chunk. Sections made of a single block type (including all-air sections)
+// are stored as one id and only allocate a per-voxel array once they stop being uniform.
+class ChunkSection
+{
+   public:
+    static const int SIZE   = 16;
+    static const int VOLUME = SIZE * SIZE * SIZE;
+
+    Block::Id getBlock(int x, int y, int z) const
+    {
+        return blocks ? blocks[blockIndex(x, y, z)] : uniformId;
+    }
+    void setBlock(int x, int y, int z, Block::Id id);
+
+    bool isEmpty() const
+    {
+        return !blocks && uniformId == Block::Id::AIR;
+    }
+    bool isUniform() const
+    {
+        return !blocks;
+    }
+    Block::Id getUniformId() const
+    {
+        return uniformId;
+    }
+
+    // Raw per-voxel ids, or nullptr for uniform sections
+    const Block::Id* data() const
+    {
+        return blocks.get();
+    }
+
+    void   fill(Block::Id id);
+    void   setData(const uint8_t* rawIds);
+    void   compact();
+    size_t memoryUsage() const;
+
+    static int blockIndex(int x, int y, int z)
+    {
+        return x + SIZE * (z + SIZE * y);
+    }
+
+   private:
+    Block::Id                    uniformId = Block::Id::AIR;
+    std::unique_ptr<Block::Id[]> blocks;
+};
@@ -0,0 +1,102 @@
+#include "chunk_writer.h"
+
+ChunkWriter::ChunkWriter(RegionLookup regionLookup, size_t capacity)
+    : regionLookup(std::move(regionLookup)), capacity(capacity)
+{
+    thread = std::thread(&ChunkWriter::writerFunc, this);
+}
+
+ChunkWriter::~ChunkWriter()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    workAvailable.notify_one();
+    if (thread.joinable())
+        thread.join();
+}
+
+bool ChunkWriter::tryEnqueue(std::shared_ptr<Chunk> chunk)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (writeQueue.size() >= capacity)
+            return false;
+
+        push(std::move(chunk));
+    }
+    workAvailable.notify_one();
+    return true;
+}
+
+void ChunkWriter::enqueue(std::shared_ptr<Chunk> chunk)
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        writeFinished.wait(lock, [&] { return writeQueue.size() < capacity; });
+
+        push(std::move(chunk));
+    }
+    workAvailable.notify_one();
+}
+
+void ChunkWriter::flush()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    writeFinished.wait(lock, [&] { return pending.empty(); });
+}
+
+std::shared_ptr<Chunk> ChunkWriter::findPending(int chunkX, int chunkZ) const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    auto                        it = pending.find({chunkX, chunkZ});
+    return it != pending.end() ? it->second.chunk : nullptr;
+}
+
+size_t ChunkWriter::getPendingCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return pending.size();
+}
+
+// Callers hold mutex
+void ChunkWriter::push(std::shared_ptr<Chunk> chunk)
+{
+    PendingWrite& entry = pending[{chunk->getX(), chunk->getZ()}];
+    entry.chunk         = chunk;
+    ++entry.writes;
+    writeQueue.push_back(std::move(chunk));
+}
+
+void ChunkWriter::writerFunc()
+{
+    while (true)
+    {
+        std::shared_ptr<Chunk> chunk;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            workAvailable.wait(lock, [&] { return !writeQueue.empty() || stopping; });
+
+            // Drain the queue before honoring a stop so no unloaded chunk is lost
+            if (writeQueue.empty())
+                return;
+
+            chunk = std::move(writeQueue.front());
+            writeQueue.pop_front();
+        }
+
+        // Compression happens in serialize, outside the lock
+        regionLookup(chunk->getX(), chunk->getZ())->saveChunk(*chunk);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            // The coordinate may have been unloaded again meanwhile; keep it until that is written
+            auto it = pending.find({chunk->getX(), chunk->getZ()});
+            if (--it->second.writes == 0)
+                pending.erase(it);
+        }
+        writeFinished.notify_all();
+    }
+}
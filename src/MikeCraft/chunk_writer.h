@@ -0,0 +1,58 @@
+#pragma once
+
+#include "chunk.h"
+#include "region_file.h"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+// Saves unloaded chunks on a background thread. A chunk stays findable through findPending until
+// its write has completed, so a reload never reads a stale copy from the region file.
+class ChunkWriter
+{
+   public:
+    using RegionLookup = std::function<RegionFile*(int chunkX, int chunkZ)>;
+
+    ChunkWriter(RegionLookup regionLookup, size_t capacity);
+    ~ChunkWriter();  // Finishes every queued write
+
+    ChunkWriter(const ChunkWriter&)            = delete;
+    ChunkWriter& operator=(const ChunkWriter&) = delete;
+
+    // Returns false without queueing when capacity writes are already waiting
+    bool tryEnqueue(std::shared_ptr<Chunk> chunk);
+    // Waits for room instead of failing
+    void enqueue(std::shared_ptr<Chunk> chunk);
+    // Blocks until every queued write has completed
+    void flush();
+
+    // Newest chunk queued or being written at these coordinates, nullptr if none
+    std::shared_ptr<Chunk> findPending(int chunkX, int chunkZ) const;
+    size_t                 getPendingCount() const;
+
+   private:
+    RegionLookup regionLookup;
+    size_t       capacity;
+
+    struct PendingWrite
+    {
+        std::shared_ptr<Chunk> chunk;       // Newest chunk queued for this coordinate
+        int                    writes = 0;  // Writes for this coordinate not yet completed
+    };
+
+    std::deque<std::shared_ptr<Chunk>>          writeQueue;
+    std::map<std::pair<int, int>, PendingWrite> pending;
+    mutable std::mutex                          mutex;
+    std::condition_variable                     workAvailable, writeFinished;
+    bool                                        stopping = false;
+    std::thread                                 thread;
+
+    void push(std::shared_ptr<Chunk> chunk);
+    void writerFunc();
+};
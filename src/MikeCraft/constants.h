@@ -14,4 +14,7 @@ constexpr int NOISE_SAMPLE_STEP = 4;
 // Add 1 to ensure smooth interpolation between regions
 constexpr int NOISE_GRID_SIZE = REGION_BLOCKS / NOISE_SAMPLE_STEP + 1;
 
+// Samples covering a single chunk, on the same lattice as the region grid
+constexpr int CHUNK_NOISE_GRID_SIZE = CHUNK_SIZE / NOISE_SAMPLE_STEP + 1;
+
 // TODO: change names for these constants
\ No newline at end of file
@@ -0,0 +1,30 @@
+#include "frustum.h"
+
+Frustum::Frustum(const glm::mat4& viewProjection)
+{
+    // Gribb-Hartmann: each plane is the fourth row of the matrix plus or minus one of the others
+    glm::mat4 m = glm::transpose(viewProjection);
+    planes[0]   = m[3] + m[0];  // Left
+    planes[1]   = m[3] - m[0];  // Right
+    planes[2]   = m[3] + m[1];  // Bottom
+    planes[3]   = m[3] - m[1];  // Top
+    planes[4]   = m[3] + m[2];  // Near
+    planes[5]   = m[3] - m[2];  // Far
+
+    for (glm::vec4& plane : planes)
+        plane /= glm::length(glm::vec3(plane));
+}
+
+// Conservative test: the box is rejected only if it lies entirely behind one plane
+bool Frustum::intersectsAABB(const glm::vec3& min, const glm::vec3& max) const
+{
+    for (const glm::vec4& plane : planes)
+    {
+        // Corner of the box furthest along the plane normal
+        glm::vec3 positive(plane.x >= 0 ? max.x : min.x, plane.y >= 0 ? max.y : min.y,
+                           plane.z >= 0 ? max.z : min.z);
+        if (glm::dot(glm::vec3(plane), positive) + plane.w < 0)
+            return false;
+    }
+    return true;
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <array>
+
+// View frustum as six inward-facing planes, extracted from a combined projection * view matrix
+class Frustum
+{
+   public:
+    explicit Frustum(const glm::mat4& viewProjection);
+
+    bool intersectsAABB(const glm::vec3& min, const glm::vec3& max) const;
+
+   private:
+    std::array<glm::vec4, 6> planes;  // xyz = normal, w = distance
+};
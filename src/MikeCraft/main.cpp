@@ -105,14 +105,16 @@ int main()
     shader.use();
     shader.setInt("atlas", 0);
 
-    Renderer       renderer(shader, camera);
+    Renderer       renderer(shader, camera, RenderMode::MULTI_DRAW_INDIRECT);
     WorldGenerator worldGenerator(0);
     ChunkManager   chunkManager(worldGenerator);
+    chunkManager.setMeshArena(renderer.getMeshArena());
 
     glm::vec3 playerPos    = camera.position;
     int       playerChunkX = static_cast<int>(std::floor(playerPos.x / Chunk::WIDTH));
     int       playerChunkZ = static_cast<int>(std::floor(playerPos.z / Chunk::DEPTH));
-    chunkManager.updateChunksAroundPlayer(playerPos.x, playerPos.z, renderRadius);
+    chunkManager.updateChunksAroundPlayer(playerPos.x, playerPos.z, renderRadius,
+                                          glm::vec2(camera.forward.x, camera.forward.z));
     lastPlayerChunkX = playerChunkX;
     lastPlayerChunkZ = playerChunkZ;
 
@@ -130,7 +132,8 @@ int main()
 
         if (playerChunkX != lastPlayerChunkX || playerChunkZ != lastPlayerChunkZ)
         {
-            chunkManager.updateChunksAroundPlayer(playerPos.x, playerPos.z, renderRadius);
+            chunkManager.updateChunksAroundPlayer(playerPos.x, playerPos.z, renderRadius,
+                                                  glm::vec2(camera.forward.x, camera.forward.z));
             lastPlayerChunkX = playerChunkX;
             lastPlayerChunkZ = playerChunkZ;
         }
@@ -0,0 +1,227 @@
+#include "mapped_file.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+class MappedFile::Mapping
+{
+   public:
+    const uint8_t* data = nullptr;
+    uint64_t       size = 0;
+
+#ifdef _WIN32
+    HANDLE mappingHandle = nullptr;
+
+    ~Mapping()
+    {
+        if (data)
+            UnmapViewOfFile(data);
+        if (mappingHandle)
+            CloseHandle(mappingHandle);
+    }
+#else
+    ~Mapping()
+    {
+        if (data)
+            munmap(const_cast<uint8_t*>(data), size);
+    }
+#endif
+};
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string& path) : path(path)
+{
+    handle = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE,
+                         FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_ALWAYS,
+                         FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE)
+        throw std::runtime_error("Failed to open file: " + path);
+
+    LARGE_INTEGER size;
+    GetFileSizeEx(handle, &size);
+    fileSize = static_cast<uint64_t>(size.QuadPart);
+}
+
+MappedFile::~MappedFile()
+{
+    mapping.reset();
+    CloseHandle(handle);
+}
+
+// An explicit offset in OVERLAPPED makes ReadFile and WriteFile positional even on a handle opened
+// for synchronous I/O
+size_t MappedFile::readAt(void* buffer, size_t size, uint64_t offset) const
+{
+    size_t total = 0;
+    while (total < size)
+    {
+        OVERLAPPED overlapped = {};
+        overlapped.Offset     = static_cast<DWORD>(offset + total);
+        overlapped.OffsetHigh = static_cast<DWORD>((offset + total) >> 32);
+        DWORD bytesRead       = 0;
+        DWORD request         = static_cast<DWORD>(std::min<size_t>(size - total, 1u << 30));
+        if (!ReadFile(handle, static_cast<char*>(buffer) + total, request, &bytesRead,
+                      &overlapped) &&
+            GetLastError() != ERROR_HANDLE_EOF)
+            throw std::runtime_error("Failed to read file: " + path);
+        if (bytesRead == 0)
+            break;
+        total += bytesRead;
+    }
+    return total;
+}
+
+void MappedFile::writeAt(const void* data, size_t size, uint64_t offset)
+{
+    size_t total = 0;
+    while (total < size)
+    {
+        OVERLAPPED overlapped = {};
+        overlapped.Offset     = static_cast<DWORD>(offset + total);
+        overlapped.OffsetHigh = static_cast<DWORD>((offset + total) >> 32);
+        DWORD bytesWritten    = 0;
+        DWORD request         = static_cast<DWORD>(std::min<size_t>(size - total, 1u << 30));
+        if (!WriteFile(handle, static_cast<const char*>(data) + total, request, &bytesWritten,
+                       &overlapped))
+            throw std::runtime_error("Failed to write file: " + path);
+        total += bytesWritten;
+    }
+
+    uint64_t end     = offset + size;
+    uint64_t current = fileSize;
+    while (current < end && !fileSize.compare_exchange_weak(current, end))
+    {
+    }
+}
+
+void MappedFile::truncate(uint64_t size)
+{
+    std::lock_guard<std::mutex> lock(mappingMutex);
+    mapping.reset();
+
+    LARGE_INTEGER position;
+    position.QuadPart = static_cast<LONGLONG>(size);
+    if (!SetFilePointerEx(handle, position, nullptr, FILE_BEGIN) || !SetEndOfFile(handle))
+        throw std::runtime_error("Failed to truncate file: " + path);
+    fileSize = size;
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& path) : path(path)
+{
+    fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0)
+        throw std::runtime_error("Failed to open file: " + path);
+
+    struct stat info;
+    fstat(fd, &info);
+    fileSize = static_cast<uint64_t>(info.st_size);
+}
+
+MappedFile::~MappedFile()
+{
+    mapping.reset();
+    close(fd);
+}
+
+size_t MappedFile::readAt(void* buffer, size_t size, uint64_t offset) const
+{
+    size_t total = 0;
+    while (total < size)
+    {
+        ssize_t bytesRead = pread(fd, static_cast<char*>(buffer) + total, size - total,
+                                  static_cast<off_t>(offset + total));
+        if (bytesRead < 0)
+            throw std::runtime_error("Failed to read file: " + path);
+        if (bytesRead == 0)
+            break;
+        total += static_cast<size_t>(bytesRead);
+    }
+    return total;
+}
+
+void MappedFile::writeAt(const void* data, size_t size, uint64_t offset)
+{
+    size_t total = 0;
+    while (total < size)
+    {
+        ssize_t bytesWritten = pwrite(fd, static_cast<const char*>(data) + total, size - total,
+                                      static_cast<off_t>(offset + total));
+        if (bytesWritten < 0)
+            throw std::runtime_error("Failed to write file: " + path);
+        total += static_cast<size_t>(bytesWritten);
+    }
+
+    uint64_t end     = offset + size;
+    uint64_t current = fileSize;
+    while (current < end && !fileSize.compare_exchange_weak(current, end))
+    {
+    }
+}
+
+void MappedFile::truncate(uint64_t size)
+{
+    std::lock_guard<std::mutex> lock(mappingMutex);
+    mapping.reset();
+
+    if (ftruncate(fd, static_cast<off_t>(size)) != 0)
+        throw std::runtime_error("Failed to truncate file: " + path);
+    fileSize = size;
+}
+
+#endif
+
+MappedFile::View MappedFile::view(uint64_t offset, size_t size)
+{
+    if (size == 0 || offset + size > fileSize)
+        return {};
+
+    std::shared_ptr<const Mapping> current;
+    {
+        std::lock_guard<std::mutex> lock(mappingMutex);
+
+        // The file has grown past the current mapping; map it again at its new size. Views into
+        // the old mapping stay valid until they are released.
+        if (!mapping || offset + size > mapping->size)
+        {
+            auto     newMapping = std::make_shared<Mapping>();
+            uint64_t mapSize    = fileSize;
+#ifdef _WIN32
+            newMapping->mappingHandle = CreateFileMappingA(
+                handle, nullptr, PAGE_READONLY, static_cast<DWORD>(mapSize >> 32),
+                static_cast<DWORD>(mapSize), nullptr);
+            if (!newMapping->mappingHandle)
+                throw std::runtime_error("Failed to map file: " + path);
+
+            void* data = MapViewOfFile(newMapping->mappingHandle, FILE_MAP_READ, 0, 0,
+                                       static_cast<SIZE_T>(mapSize));
+            if (!data)
+                throw std::runtime_error("Failed to map file: " + path);
+#else
+            void* data = mmap(nullptr, mapSize, PROT_READ, MAP_SHARED, fd, 0);
+            if (data == MAP_FAILED)
+                throw std::runtime_error("Failed to map file: " + path);
+#endif
+            newMapping->data = static_cast<const uint8_t*>(data);
+            newMapping->size = mapSize;
+            mapping          = std::move(newMapping);
+        }
+        current = mapping;
+    }
+
+    std::span<const uint8_t> bytes(current->data + offset, size);
+    return {std::move(current), bytes};
+}
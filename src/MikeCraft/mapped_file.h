@@ -0,0 +1,59 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+
+// File accessed with positional reads and writes (pread/pwrite, or ReadFile/WriteFile with an
+// explicit offset on Windows), so threads never share a file position. Reads can also be served
+// as views into a read-only mapping of the file, straight from the page cache.
+class MappedFile
+{
+   public:
+    class Mapping;
+
+    // Bytes inside a mapping; holding the view keeps the mapping alive even after a remap
+    struct View
+    {
+        std::shared_ptr<const Mapping> mapping;
+        std::span<const uint8_t>       bytes;
+    };
+
+    // Opens the file, creating it empty if it does not exist
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&)            = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    uint64_t getSize() const
+    {
+        return fileSize;
+    }
+
+    // Returns the number of bytes read, which is short only at the end of the file
+    size_t readAt(void* buffer, size_t size, uint64_t offset) const;
+    void   writeAt(const void* data, size_t size, uint64_t offset);
+
+    // No view may be alive while the file shrinks
+    void truncate(uint64_t size);
+
+    // Empty if the range is not entirely inside the file. Writes to the range are visible
+    // through the view, so callers must not overwrite bytes another thread is still reading.
+    View view(uint64_t offset, size_t size);
+
+   private:
+#ifdef _WIN32
+    void* handle;
+#else
+    int fd;
+#endif
+    std::string           path;
+    std::atomic<uint64_t> fileSize{0};
+
+    std::mutex                     mappingMutex;
+    std::shared_ptr<const Mapping> mapping;  // Covers the file as it was when last mapped
+};
@@ -0,0 +1,140 @@
+#include "noise_grid_cache.h"
+
+size_t RegionNoiseGrids::memoryUsage() const
+{
+    size_t bytes = sizeof(RegionNoiseGrids);
+    for (const std::vector<float>& grid : channels)
+        bytes += grid.capacity() * sizeof(float);
+    return bytes;
+}
+
+NoiseGridCache::NoiseGridCache(const WorldGenerator& generator, float frequency,
+                               size_t budgetMegabytes)
+    : generator(generator), frequency(frequency), budgetBytes(budgetMegabytes * 1024 * 1024)
+{
+}
+
+std::shared_ptr<const RegionNoiseGrids> NoiseGridCache::get(int regionX, int regionZ, int seed)
+{
+    Key                   key = makeKey(regionX, regionZ, seed);
+    std::shared_ptr<Slot> slot;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto                        it = index.find(key);
+        if (it != index.end())
+        {
+            ++hits;
+            entries.splice(entries.begin(), entries, it->second);
+            slot = it->second->slot;
+        }
+        else
+        {
+            ++misses;
+            slot = std::make_shared<Slot>();
+            entries.push_front({key, slot, 0});
+            index[key] = entries.begin();
+        }
+    }
+
+    // Generate outside the cache lock so other regions are not held up
+    std::call_once(slot->generated,
+                   [&]
+                   {
+                       auto grids = std::make_shared<RegionNoiseGrids>();
+                       generator.generateRegionNoiseGrids(grids->channels, regionX, regionZ,
+                                                          frequency, seed);
+
+                       // Only count the grids if their entry was not evicted in the meantime
+                       std::lock_guard<std::mutex> lock(mutex);
+                       slot->grids = std::move(grids);
+                       auto it     = index.find(key);
+                       if (it != index.end() && it->second->slot == slot)
+                       {
+                           it->second->bytes = slot->grids->memoryUsage();
+                           usedBytes += it->second->bytes;
+                           evict();
+                       }
+                   });
+    return slot->grids;
+}
+
+NoiseGridCache::Lookup NoiseGridCache::find(int regionX, int regionZ, int seed)
+{
+    Key                         key = makeKey(regionX, regionZ, seed);
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto it = index.find(key);
+    if (it != index.end())
+    {
+        entries.splice(entries.begin(), entries, it->second);
+        const auto& grids = it->second->slot->grids;
+        if (grids)
+            ++hits;
+        else
+            ++misses;
+        return {grids, false};
+    }
+
+    ++misses;
+    entries.push_front({key, std::make_shared<Slot>(), 0});
+    index[key] = entries.begin();
+    return {nullptr, true};
+}
+
+void NoiseGridCache::setBudget(size_t megabytes)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    budgetBytes = megabytes * 1024 * 1024;
+    evict();
+}
+
+void NoiseGridCache::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+    index.clear();
+    usedBytes = 0;
+}
+
+size_t NoiseGridCache::getHitCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return hits;
+}
+
+size_t NoiseGridCache::getMissCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return misses;
+}
+
+size_t NoiseGridCache::getMemoryUsage() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return usedBytes;
+}
+
+size_t NoiseGridCache::getEntryCount() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries.size();
+}
+
+// Grids generated for one terrain formula lack the channels another one reads, so replacing the
+// formula never hands out stale entries
+NoiseGridCache::Key NoiseGridCache::makeKey(int regionX, int regionZ, int seed) const
+{
+    return {regionX, regionZ, seed, generator.getTerrainKernel().getChannelMask()};
+}
+
+// Callers hold mutex
+void NoiseGridCache::evict()
+{
+    while (usedBytes > budgetBytes && !entries.empty())
+    {
+        const Entry& oldest = entries.back();
+        usedBytes -= oldest.bytes;
+        index.erase(oldest.key);
+        entries.pop_back();
+    }
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "world_generator.h"
+
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+// Noise sampled every NOISE_SAMPLE_STEP blocks across one region, shared by all of its chunks
+struct RegionNoiseGrids
+{
+    NoiseChannelGrids channels;
+
+    size_t memoryUsage() const;
+};
+
+// Region noise grids keyed by region, seed and the channels the terrain formula uses, independent
+// of region files. Each grid set is generated once, even when several workers ask for it at the
+// same time, and handed out as immutable shared data. Bounded by a memory budget and evicted least
+// recently used first; evicted grids stay alive for as long as a caller holds them. Thread-safe.
+class NoiseGridCache
+{
+   public:
+    NoiseGridCache(const WorldGenerator& generator, float frequency, size_t budgetMegabytes);
+
+    struct Lookup
+    {
+        std::shared_ptr<const RegionNoiseGrids> grids;    // Null until generated
+        bool                                    created;  // This call added the entry
+    };
+
+    // Generates the grids on a miss; concurrent callers for the same key wait for that generation
+    std::shared_ptr<const RegionNoiseGrids> get(int regionX, int regionZ, int seed);
+    // Never waits. A miss adds an empty entry, and only the caller that added it sees created, so
+    // exactly one caller schedules the get() that fills it.
+    Lookup find(int regionX, int regionZ, int seed);
+
+    void setBudget(size_t megabytes);
+    void clear();
+
+    size_t getHitCount() const;
+    size_t getMissCount() const;
+    size_t getMemoryUsage() const;
+    size_t getEntryCount() const;
+
+   private:
+    using Key = std::tuple<int, int, int, uint32_t>;  // Region x, region z, seed, channel mask
+
+    struct Slot
+    {
+        std::once_flag                          generated;
+        std::shared_ptr<const RegionNoiseGrids> grids;  // Set under the cache mutex
+    };
+
+    struct Entry
+    {
+        Key                   key;
+        std::shared_ptr<Slot> slot;
+        size_t                bytes;  // 0 until generated
+    };
+
+    const WorldGenerator& generator;
+    float                 frequency;
+
+    mutable std::mutex                        mutex;
+    std::list<Entry>                          entries;  // Most recently used first
+    std::map<Key, std::list<Entry>::iterator> index;
+
+    size_t budgetBytes;
+    size_t usedBytes = 0;
+    size_t hits = 0, misses = 0;
+
+    Key  makeKey(int regionX, int regionZ, int seed) const;
+    void evict();
+};
@@ -1,86 +1,100 @@
 #include "constants.h"
 #include "region_file.h"
 
+#include <algorithm>
+#include <ctime>
+#include <filesystem>
+#include <iostream>
+
+namespace
+{
+    // Saves between header write-backs
+    constexpr int headerFlushInterval = 32;
+}  // namespace
+
 RegionFile::RegionFile(const std::string& filePath) : filePath(filePath)
 {
-    file.open(filePath, std::ios::binary | std::ios::in | std::ios::out);
+    if (std::filesystem::exists(filePath))
+        openFile();
+}
+
+RegionFile::~RegionFile()
+{
     if (!file)
+        return;
+
+    // Normally ChunkManager::unloadAllChunks has flushed already. An I/O error here can only be
+    // reported, since throwing out of a destructor would terminate the game.
+    try
     {
-        initializeRegionFile();
-        file.open(filePath, std::ios::binary | std::ios::in | std::ios::out);
-        if (!file)
+        flush();
+
+        // Drop free sectors at the end of the file; nothing can hold a view by now
+        if (truncateOnClose && !freeByOffset.empty())
         {
-            throw std::runtime_error("Failed to open region file: " + filePath);
+            auto last = std::prev(freeByOffset.end());
+            if (static_cast<uint64_t>(last->first + last->second) * SECTOR_BYTES >=
+                file->getSize())
+                file->truncate(static_cast<uint64_t>(last->first) * SECTOR_BYTES);
         }
     }
-    rebuildFreeList();
+    catch (const std::exception& e)
+    {
+        std::cerr << "Failed to close region file " << filePath << ": " << e.what() << std::endl;
+    }
 }
 
-void RegionFile::generateNoiseGrids(const WorldGenerator& generator, int regionX, int regionZ,
-                                    float frequency, int seed)
+// Helper to load a chunk from the region file
+MappedFile::View RegionFile::loadChunk(int chunkX, int chunkZ)
 {
-    size_t expectedSize = NOISE_GRID_SIZE * NOISE_GRID_SIZE;
-
-    // clang-format off
-    if (continentGrid.size() == expectedSize &&
-        erosionGrid.size()   == expectedSize &&
-        pvGrid.size()        == expectedSize)
-    {
-        return;
-    }
-    // clang-format on
+    std::optional<ChunkLocation> location = locateChunk(chunkX, chunkZ);
+    if (!location)
+        return {};
 
-    generator.generateRegionNoiseGrids(continentGrid, erosionGrid, pvGrid, regionX, regionZ,
-                                       frequency, seed);
+    // The sectors stay untouched while the view is alive: only a later save of this same chunk
+    // could reuse them, and a chunk is never saved while it is being loaded
+    return file->view(location->offset, location->size);
 }
 
-// Helper to load a chunk from the region file
-std::vector<uint8_t> RegionFile::loadChunk(int chunkX, int chunkZ)
+std::optional<RegionFile::ChunkLocation> RegionFile::locateChunk(int chunkX, int chunkZ)
 {
-    std::lock_guard<std::mutex> lock(fileMutex);
+    std::shared_lock<std::shared_mutex> lock(fileMutex);
 
     // Use & instead of % to prevent negative values
-    int index = 4 * ((chunkX & (REGION_SIZE - 1)) + (chunkZ & (REGION_SIZE - 1)) * REGION_SIZE);
-
-    file.seekg(index, std::ios::beg);
-    uint32_t locationEntry;
-    file.read(reinterpret_cast<char*>(&locationEntry), sizeof(locationEntry));
+    int index = (chunkX & (REGION_SIZE - 1)) + (chunkZ & (REGION_SIZE - 1)) * REGION_SIZE;
 
     // First 3 bytes are the offset, last byte is the size
     // Stored in 4KiB sectors
-    uint32_t offsetBytes = (locationEntry >> 8) * SECTOR_BYTES;
-    uint8_t  sectorCount = locationEntry & 0xFF;
+    uint32_t locationEntry = locations[index];
+    uint32_t offsetBytes   = (locationEntry >> 8) * SECTOR_BYTES;
+    uint8_t  sectorCount   = locationEntry & 0xFF;
 
     if (offsetBytes == 0 || sectorCount == 0)
     {
         // Chunk not found
-        return {};
+        return std::nullopt;
     }
 
-    file.seekg(offsetBytes, std::ios::beg);
-    std::vector<uint8_t> data(sectorCount * SECTOR_BYTES);
-    file.read(reinterpret_cast<char*>(data.data()), data.size());
-
-    return data;
+    return ChunkLocation{offsetBytes, static_cast<uint32_t>(sectorCount) * SECTOR_BYTES};
 }
 
 void RegionFile::saveChunk(const Chunk& chunk)
 {
-    std::lock_guard<std::mutex> lock(fileMutex);
+    // Compress before taking the lock so loads in this region are not held up by it
+    auto data = chunk.serialize();
+
+    std::unique_lock<std::shared_mutex> lock(fileMutex);
+    if (!file)
+        openFile();
 
     // Use & instead of % to prevent negative values
     int index =
-        4 * ((chunk.getX() & (REGION_SIZE - 1)) + (chunk.getZ() & (REGION_SIZE - 1)) * REGION_SIZE);
-
-    file.seekg(index, std::ios::beg);
-    uint32_t locationEntry;
-    file.read(reinterpret_cast<char*>(&locationEntry), sizeof(locationEntry));
+        (chunk.getX() & (REGION_SIZE - 1)) + (chunk.getZ() & (REGION_SIZE - 1)) * REGION_SIZE;
 
+    uint32_t locationEntry       = locations[index];
     uint32_t currentSectorOffset = (locationEntry >> 8);
-    uint32_t currentOffsetBytes  = (locationEntry >> 8) * SECTOR_BYTES;
     uint8_t  currentSectorCount  = locationEntry & 0xFF;
 
-    auto data = chunk.serialize();
     // Pad chunk data to be a multiple of 4 KiB
     uint32_t newSectorCount = (data.size() + SECTOR_BYTES - 1) / SECTOR_BYTES;
     data.resize(newSectorCount * SECTOR_BYTES, 0);
@@ -90,59 +104,73 @@ void RegionFile::saveChunk(const Chunk& chunk)
     if (currentSectorOffset != 0 && newSectorCount <= currentSectorCount)
     {
         newSectorOffset = currentSectorOffset;
-        file.seekp(currentOffsetBytes, std::ios::beg);
-        file.write(reinterpret_cast<const char*>(data.data()), data.size());
+
+        // Release the tail when the chunk shrank
+        if (newSectorCount < currentSectorCount)
+            pendingFree.push_back(
+                {currentSectorOffset + newSectorCount, currentSectorCount - newSectorCount});
     }
     else
     {
         if (currentSectorOffset != 0)
         {
-            addFreeRegion(currentSectorOffset, currentSectorCount);
+            pendingFree.push_back({currentSectorOffset, currentSectorCount});
         }
 
-        auto freeRegion = findFreeRegion(newSectorCount);
-        if (freeRegion)
-        {
-            newSectorOffset = freeRegion->offset;
-        }
-        else
-        {
-            file.seekp(0, std::ios::end);
-            newSectorOffset = file.tellp() / SECTOR_BYTES;
-        }
-
-        file.seekp(newSectorOffset * SECTOR_BYTES, std::ios::beg);
-        file.write(reinterpret_cast<const char*>(data.data()), data.size());
+        newSectorOffset = allocateSectors(newSectorCount);
     }
 
-    locationEntry = (newSectorOffset << 8) | newSectorCount;
-    file.seekp(index, std::ios::beg);
-    file.write(reinterpret_cast<const char*>(&locationEntry), sizeof(locationEntry));
+    file->writeAt(data.data(), data.size(), static_cast<uint64_t>(newSectorOffset) * SECTOR_BYTES);
+
+    locations[index]  = (newSectorOffset << 8) | newSectorCount;
+    timestamps[index] = static_cast<uint32_t>(time(nullptr));
 
-    uint32_t timestamp = static_cast<uint32_t>(time(nullptr));
-    file.seekp(SECTOR_BYTES + index, std::ios::beg);
-    file.write(reinterpret_cast<const char*>(&timestamp), sizeof(timestamp));
+    dirtyBegin = std::min(dirtyBegin, index);
+    dirtyEnd   = std::max(dirtyEnd, index + 1);
+    if (++dirtySaves >= headerFlushInterval)
+        flushHeader();
 }
 
-void RegionFile::rebuildFreeList()
+void RegionFile::flush()
 {
-    const int LOCATION_TABLE_SIZE = REGION_SIZE * REGION_SIZE;
+    std::unique_lock<std::shared_mutex> lock(fileMutex);
+    flushHeader();
+}
 
-    file.seekg(0, std::ios::end);
-    std::streamsize fileSize     = file.tellg();
-    uint32_t        totalSectors = static_cast<uint32_t>(fileSize / SECTOR_BYTES);
+// Callers hold fileMutex exclusively
+void RegionFile::flushHeader()
+{
+    if (dirtyBegin < dirtyEnd)
+    {
+        size_t count = dirtyEnd - dirtyBegin;
+        file->writeAt(&locations[dirtyBegin], count * sizeof(uint32_t),
+                     dirtyBegin * sizeof(uint32_t));
+        file->writeAt(&timestamps[dirtyBegin], count * sizeof(uint32_t),
+                     SECTOR_BYTES + dirtyBegin * sizeof(uint32_t));
+    }
+    dirtyBegin = ENTRY_COUNT;
+    dirtyEnd   = 0;
+    dirtySaves = 0;
+
+    // The header on disk no longer references these sectors
+    for (const FreeRegion& region : pendingFree)
+        addFreeRegion(region.offset, region.size);
+    pendingFree.clear();
+}
+
+void RegionFile::rebuildFreeList()
+{
+    uint32_t totalSectors = static_cast<uint32_t>(file->getSize() / SECTOR_BYTES);
 
     std::vector<bool> sectorUsed(totalSectors, false);
     sectorUsed[0] = true;
     sectorUsed[1] = true;
 
-    file.seekg(0, std::ios::beg);
-    for (int i = 0; i < LOCATION_TABLE_SIZE; ++i)
+    // Decode entries the same way loadChunk and saveChunk do
+    for (int i = 0; i < ENTRY_COUNT; ++i)
     {
-        uint8_t entry[4];
-        file.read(reinterpret_cast<char*>(entry), 4);
-        uint32_t offset      = (entry[0] << 16) | (entry[1] << 8) | entry[2];
-        uint8_t  sectorCount = entry[3];
+        uint32_t offset      = locations[i] >> 8;
+        uint8_t  sectorCount = locations[i] & 0xFF;
         if (offset != 0 && sectorCount != 0)
         {
             for (uint8_t s = 0; s < sectorCount; ++s)
@@ -154,7 +182,8 @@ void RegionFile::rebuildFreeList()
         }
     }
 
-    freeList.clear();
+    freeByOffset.clear();
+    freeBySize.clear();
     uint32_t start = 0;
     while (start < totalSectors)
     {
@@ -165,72 +194,108 @@ void RegionFile::rebuildFreeList()
         uint32_t end = start;
         while (end < totalSectors && !sectorUsed[end])
             ++end;
-        freeList.push_back({start, end - start});
+        addFreeRegion(start, end - start);
         start = end;
     }
 }
 
+// Best fit: the smallest free region that is large enough, lowest offset among equal sizes
 std::optional<RegionFile::FreeRegion> RegionFile::findFreeRegion(uint32_t sectorCount)
 {
-    for (auto it = freeList.begin(); it != freeList.end(); ++it)
-    {
-        if (sectorCount <= it->size)
-        {
-            FreeRegion region = *it;
+    auto it = freeBySize.lower_bound({sectorCount, 0});
+    if (it == freeBySize.end())
+        return std::nullopt;
 
-            // If the free region is larger than needed, split it
-            if (it->size > sectorCount)
-            {
-                it->offset += sectorCount;
-                it->size -= sectorCount;
-            }
-            else
-            {
-                // Remove the region from the free list if it's fully used
-                freeList.erase(it);
-            }
+    uint32_t size   = it->first;
+    uint32_t offset = it->second;
+    freeBySize.erase(it);
+    freeByOffset.erase(offset);
 
-            return region;
-        }
+    // If the free region is larger than needed, keep the rest
+    if (size > sectorCount)
+    {
+        freeByOffset[offset + sectorCount] = size - sectorCount;
+        freeBySize.insert({size - sectorCount, offset + sectorCount});
     }
 
-    return std::nullopt;
+    return FreeRegion{offset, sectorCount};
 }
 
+// Merges with the free regions on both sides
 void RegionFile::addFreeRegion(uint32_t offset, uint32_t size)
 {
-    for (auto it = freeList.begin(); it != freeList.end(); ++it)
+    auto next = freeByOffset.lower_bound(offset);
+    if (next != freeByOffset.begin())
     {
-        // Merge with an adjacent free region
-        if (it->offset + it->size == offset)
-        {
-            it->size += size;
-            return;
-        }
-        else if (offset + size == it->offset)
+        auto previous = std::prev(next);
+        if (previous->first + previous->second == offset)
         {
-            it->offset = offset;
-            it->size += size;
-            return;
+            offset = previous->first;
+            size += previous->second;
+            freeBySize.erase({previous->second, previous->first});
+            freeByOffset.erase(previous);
         }
     }
+    if (next != freeByOffset.end() && offset + size == next->first)
+    {
+        size += next->second;
+        freeBySize.erase({next->second, next->first});
+        freeByOffset.erase(next);
+    }
 
-    // No adjacent region found, add a new entry
-    freeList.push_back({offset, size});
+    freeByOffset[offset] = size;
+    freeBySize.insert({size, offset});
 }
 
-void RegionFile::initializeRegionFile()
+// Falls back to growing the file, starting inside a free region that already reaches its end
+uint32_t RegionFile::allocateSectors(uint32_t sectorCount)
 {
-    std::ofstream out(filePath, std::ios::binary);
-    if (!out)
+    if (auto region = findFreeRegion(sectorCount))
+        return region->offset;
+
+    uint32_t endSector = static_cast<uint32_t>((file->getSize() + SECTOR_BYTES - 1) / SECTOR_BYTES);
+    if (!freeByOffset.empty())
     {
-        throw std::runtime_error("Failed to create region file: " + filePath);
+        auto last = std::prev(freeByOffset.end());
+        if (last->first + last->second == endSector)
+        {
+            uint32_t offset = last->first;
+            freeBySize.erase({last->second, last->first});
+            freeByOffset.erase(last);
+            return offset;
+        }
     }
+    return endSector;
+}
+
+void RegionFile::setTruncateOnClose(bool truncate)
+{
+    std::unique_lock<std::shared_mutex> lock(fileMutex);
+    truncateOnClose = truncate;
+}
 
+// Called from the constructor, or by a save holding fileMutex exclusively
+void RegionFile::openFile()
+{
+    file = std::make_unique<MappedFile>(filePath);
+    if (file->getSize() == 0)
+        initializeRegionFile();
+
+    // Both header tables in one read
+    std::vector<uint32_t> header(ENTRY_COUNT * 2, 0);
+    file->readAt(header.data(), header.size() * sizeof(uint32_t), 0);
+    std::copy(header.begin(), header.begin() + ENTRY_COUNT, locations.begin());
+    std::copy(header.begin() + ENTRY_COUNT, header.end(), timestamps.begin());
+
+    rebuildFreeList();
+}
+
+void RegionFile::initializeRegionFile()
+{
     // 1024 * 4 bytes for the location table
     // 1024 * 4 bytes for the timestamp table
     const size_t HEADER_SIZE = (REGION_SIZE * REGION_SIZE * 4) * 2;
 
     std::vector<uint8_t> header(HEADER_SIZE, 0);
-    out.write(reinterpret_cast<const char*>(header.data()), header.size());
+    file->writeAt(header.data(), header.size(), 0);
 }
\ No newline at end of file
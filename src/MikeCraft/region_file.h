@@ -1,14 +1,18 @@
 #pragma once
 
 #include "chunk.h"
-#include "world_generator.h"
+#include "constants.h"
+#include "mapped_file.h"
 
+#include <array>
 #include <vector>
 #include <string>
 #include <memory>
+#include <map>
 #include <optional>
-#include <fstream>
+#include <set>
 #include <mutex>
+#include <shared_mutex>
 
 class RegionFile
 {
@@ -19,26 +23,53 @@ class RegionFile
         uint32_t size;    // Size in 4 KiB sectors
     };
 
+    // Opens the file if it exists. Otherwise the region reads as empty and the first save creates
+    // the file, so regions that are only ever generated never reach the disk.
     explicit RegionFile(const std::string& filePath);
+    ~RegionFile();  // Flushes the header, then truncates trailing free sectors if enabled
 
-    std::vector<float> continentGrid;
-    std::vector<float> erosionGrid;
-    std::vector<float> pvGrid;
-
-    void generateNoiseGrids(const WorldGenerator& generator, int regionX, int regionZ,
-                            float frequency, int seed);
-
-    std::vector<uint8_t>      loadChunk(int chunkX, int chunkZ);
+    // Compressed chunk data as a view into the mapped file, empty if the chunk was never saved.
+    // Any number of threads can load at once; saves are exclusive.
+    MappedFile::View          loadChunk(int chunkX, int chunkZ);
     void                      saveChunk(const Chunk& chunk);
+    void                      flush();  // Writes header entries changed since the last flush
     void                      rebuildFreeList();
     std::optional<FreeRegion> findFreeRegion(uint32_t sectorCount);
     void                      addFreeRegion(uint32_t offset, uint32_t size);
+    void                      setTruncateOnClose(bool truncate);
 
    private:
-    std::string             filePath;
-    std::fstream            file;
-    std::vector<FreeRegion> freeList;
-    std::mutex              fileMutex;
+    // Byte range of a saved chunk's sectors
+    struct ChunkLocation
+    {
+        uint64_t offset;
+        uint32_t size;
+    };
+
+    static constexpr int ENTRY_COUNT = REGION_SIZE * REGION_SIZE;
+
+    std::string                 filePath;
+    std::unique_ptr<MappedFile> file;  // Null until the file exists
+    std::shared_mutex           fileMutex;
+    bool                        truncateOnClose = false;
+
+    // Free sectors indexed both ways: by offset for coalescing, by (size, offset) for best fit
+    std::map<uint32_t, uint32_t>            freeByOffset;
+    std::set<std::pair<uint32_t, uint32_t>> freeBySize;
+
+    // In-memory copy of the 8 KiB header. Saves only touch these; changed entries are written
+    // back as one contiguous range per table once enough accumulate, or on flush.
+    std::array<uint32_t, ENTRY_COUNT> locations{};
+    std::array<uint32_t, ENTRY_COUNT> timestamps{};
+    int                               dirtyBegin = ENTRY_COUNT, dirtyEnd = 0, dirtySaves = 0;
+
+    // Sectors released by saves the on-disk header does not reflect yet. They only become
+    // reusable after a flush, so a crash never leaves an old entry pointing at reused sectors.
+    std::vector<FreeRegion> pendingFree;
 
-    void initializeRegionFile();
+    void                         openFile();
+    void                         initializeRegionFile();
+    void                         flushHeader();
+    uint32_t                     allocateSectors(uint32_t sectorCount);
+    std::optional<ChunkLocation> locateChunk(int chunkX, int chunkZ);
 };
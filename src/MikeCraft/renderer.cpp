@@ -1,4 +1,5 @@
 #include "renderer.h"
+#include "frustum.h"
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
@@ -8,38 +9,191 @@ GLuint Renderer::VBO                  = 0;
 GLuint Renderer::EBO                  = 0;
 bool   Renderer::blockMeshInitialized = false;
 
-Renderer::Renderer(Shader& shader, Camera& camera) : shader(shader), camera(camera)
+namespace
+{
+    // Initial arena size in packed vertices (16 MiB); the arena grows on demand
+    constexpr uint32_t initialArenaCapacity = 4 * 1024 * 1024;
+}  // namespace
+
+Renderer::Renderer(Shader& shader, Camera& camera, RenderMode mode)
+    : shader(shader), camera(camera), mode(mode)
 {
     initBlockMesh();
+    initCameraBuffer();
+    if (mode == RenderMode::MULTI_DRAW_INDIRECT)
+        initIndirect();
+
+    // The per-chunk path leaves the chunk position attribute disabled, so it reads this value
+    glVertexAttribI2i(1, 0, 0);
+}
+
+Renderer::~Renderer()
+{
+    glDeleteBuffers(1, &cameraUBO);
+    if (indirectVAO != 0)
+    {
+        glDeleteVertexArrays(1, &indirectVAO);
+        glDeleteBuffers(1, &commandBuffer);
+        glDeleteBuffers(1, &positionBuffer);
+    }
 }
 
 void Renderer::renderChunk(const Chunk& chunk)
+{
+    shader.use();
+    updateCameraBuffer({camera.getViewMatrix(), camera.getProjectionMatrix()});
+    drawChunk(chunk);
+}
+
+// Expects the shader bound and the camera buffer current
+void Renderer::drawChunk(const Chunk& chunk)
 {
     // Assume chunk.uploadMeshToGPU() has already been called and mesh is ready
     if (!chunk.meshGenerated || chunk.VAO == 0)
         return;
 
-    shader.use();
-    shader.setMat4("view", camera.getViewMatrix());
-    shader.setMat4("projection", camera.getProjectionMatrix());
-
     glm::mat4 model = glm::translate(
         glm::mat4(1.0f), glm::vec3(chunk.getX() * Chunk::WIDTH, 0, chunk.getZ() * Chunk::DEPTH));
-    shader.setMat4("model", model);
+    shader.setMat4(modelLocation, model);
 
     glBindVertexArray(chunk.VAO);
-    glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(chunk.meshIndices.size()), GL_UNSIGNED_INT,
-                   0);
+    glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(chunk.mesh.getQuadCount() * 6),
+                   GL_UNSIGNED_INT, 0);
     glBindVertexArray(0);
 }
 
 void Renderer::renderChunks(const std::vector<Chunk*>& chunks)
 {
+    // Build the camera matrices once per frame; culling and every draw share them
+    CameraMatrices matrices{camera.getViewMatrix(), camera.getProjectionMatrix()};
+    Frustum        frustum(matrices.projection * matrices.view);
+
+    visibleChunks.clear();
+    culledChunkCount = 0;
+    for (const Chunk* chunk : chunks)
+    {
+        if (!chunk || !chunk->meshGenerated || chunk->mesh.getQuadCount() == 0)
+            continue;
+
+        glm::vec3 origin(chunk->getX() * Chunk::WIDTH, 0, chunk->getZ() * Chunk::DEPTH);
+        glm::vec3 min = origin + glm::vec3(0, chunk->mesh.minY, 0);
+        glm::vec3 max = origin + glm::vec3(Chunk::WIDTH, chunk->mesh.maxY, Chunk::DEPTH);
+        if (!frustum.intersectsAABB(min, max))
+        {
+            ++culledChunkCount;
+            continue;
+        }
+        visibleChunks.push_back(chunk);
+    }
+    drawnChunkCount = visibleChunks.size();
+
+    shader.use();
+    updateCameraBuffer(matrices);
+
+    if (mode == RenderMode::MULTI_DRAW_INDIRECT)
+    {
+        renderChunksIndirect(visibleChunks);
+        return;
+    }
+
+    for (const Chunk* chunk : visibleChunks)
+        drawChunk(*chunk);
+}
+
+// One indirect command per chunk; baseInstance selects the chunk position from the instanced
+// attribute, so the whole world is a single draw call with no per-chunk state changes
+void Renderer::renderChunksIndirect(const std::vector<const Chunk*>& chunks)
+{
+    drawCommands.clear();
+    chunkPositions.clear();
     for (const Chunk* chunk : chunks)
     {
-        if (chunk)
-            renderChunk(*chunk);
+        if (chunk->arenaHandle == ChunkMeshArena::INVALID_HANDLE)
+            continue;
+
+        DrawElementsIndirectCommand command;
+        command.count         = static_cast<GLuint>(chunk->mesh.getQuadCount() * 6);
+        command.instanceCount = 1;
+        command.firstIndex    = 0;
+        command.baseVertex    = meshArena->getBaseVertex(chunk->arenaHandle);
+        command.baseInstance  = static_cast<GLuint>(drawCommands.size());
+        drawCommands.push_back(command);
+        chunkPositions.emplace_back(chunk->getX(), chunk->getZ());
     }
+    if (drawCommands.empty())
+        return;
+
+    shader.setMat4(modelLocation, glm::mat4(1.0f));
+
+    glBindVertexArray(indirectVAO);
+
+    // The arena swaps its buffer when it grows or defragments
+    if (boundArenaGeneration != meshArena->getGeneration())
+    {
+        boundArenaGeneration = meshArena->getGeneration();
+        glBindBuffer(GL_ARRAY_BUFFER, meshArena->getBuffer());
+        glVertexAttribIPointer(0, 1, GL_UNSIGNED_INT, sizeof(GLuint), (void*) 0);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, positionBuffer);
+    glBufferData(GL_ARRAY_BUFFER, chunkPositions.size() * sizeof(glm::ivec2), chunkPositions.data(),
+                 GL_STREAM_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+    glBufferData(GL_DRAW_INDIRECT_BUFFER, drawCommands.size() * sizeof(DrawElementsIndirectCommand),
+                 drawCommands.data(), GL_STREAM_DRAW);
+
+    glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr,
+                                static_cast<GLsizei>(drawCommands.size()), 0);
+
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    glBindVertexArray(0);
+}
+
+void Renderer::updateCameraBuffer(const CameraMatrices& matrices)
+{
+    glBindBuffer(GL_UNIFORM_BUFFER, cameraUBO);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(CameraMatrices), &matrices);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void Renderer::initCameraBuffer()
+{
+    // Two column-major mat4s match the std140 layout of the CameraMatrices block
+    glGenBuffers(1, &cameraUBO);
+    glBindBuffer(GL_UNIFORM_BUFFER, cameraUBO);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(CameraMatrices), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    glBindBufferBase(GL_UNIFORM_BUFFER, CAMERA_UBO_BINDING, cameraUBO);
+
+    shader.bindUniformBlock("CameraMatrices", CAMERA_UBO_BINDING);
+    modelLocation = shader.getUniformLocation("model");
+}
+
+void Renderer::initIndirect()
+{
+    meshArena = std::make_unique<ChunkMeshArena>(initialArenaCapacity);
+
+    glGenVertexArrays(1, &indirectVAO);
+    glGenBuffers(1, &commandBuffer);
+    glGenBuffers(1, &positionBuffer);
+
+    glBindVertexArray(indirectVAO);
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, Chunk::getQuadIndexBuffer());
+
+    // Packed vertex attribute, pointed at the arena buffer before drawing
+    glEnableVertexAttribArray(0);
+
+    // Chunk position attribute (2 ints), advanced once per draw via baseInstance
+    glBindBuffer(GL_ARRAY_BUFFER, positionBuffer);
+    glVertexAttribIPointer(1, 2, GL_INT, sizeof(glm::ivec2), (void*) 0);
+    glVertexAttribDivisor(1, 1);
+    glEnableVertexAttribArray(1);
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindVertexArray(0);
 }
 
 void Renderer::initBlockMesh()
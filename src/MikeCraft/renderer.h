@@ -2,21 +2,86 @@
 
 #include "camera.h"
 #include "chunk.h"
+#include "chunk_mesh_arena.h"
 #include "shader.h"
 
 #include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <memory>
+#include <vector>
+
+enum class RenderMode
+{
+    PER_CHUNK,            // One VAO and glDrawElements call per chunk
+    MULTI_DRAW_INDIRECT,  // All chunks in one arena, drawn by one glMultiDrawElementsIndirect
+};
 
 class Renderer
 {
    public:
-    Renderer(Shader& shader, Camera& camera);
+    Renderer(Shader& shader, Camera& camera, RenderMode mode = RenderMode::PER_CHUNK);
+    ~Renderer();
+
     void renderChunk(const Chunk& chunk);
     void renderChunks(const std::vector<Chunk*>& chunks);
 
+    // Chunks submitted and rejected by frustum culling during the last renderChunks call
+    size_t getDrawnChunkCount() const
+    {
+        return drawnChunkCount;
+    }
+    size_t getCulledChunkCount() const
+    {
+        return culledChunkCount;
+    }
+
+    // Arena chunk meshes must be uploaded into for MULTI_DRAW_INDIRECT, nullptr otherwise
+    ChunkMeshArena* getMeshArena() const
+    {
+        return meshArena.get();
+    }
+
    private:
-    Shader&       shader;
-    Camera&       camera;
+    struct DrawElementsIndirectCommand
+    {
+        GLuint count;
+        GLuint instanceCount;
+        GLuint firstIndex;
+        GLint  baseVertex;
+        GLuint baseInstance;
+    };
+
+    struct CameraMatrices
+    {
+        glm::mat4 view;
+        glm::mat4 projection;
+    };
+
+    Shader&    shader;
+    Camera&    camera;
+    RenderMode mode;
+
+    GLuint cameraUBO     = 0;
+    GLint  modelLocation = -1;
+
+    std::unique_ptr<ChunkMeshArena>          meshArena;
+    GLuint                                   indirectVAO = 0, commandBuffer = 0, positionBuffer = 0;
+    uint32_t                                 boundArenaGeneration = 0;  // 0 before first bind
+    std::vector<DrawElementsIndirectCommand> drawCommands;
+    std::vector<glm::ivec2>                  chunkPositions;
+    std::vector<const Chunk*>                visibleChunks;
+    size_t                                   drawnChunkCount = 0, culledChunkCount = 0;
+
+    void initCameraBuffer();
+    void updateCameraBuffer(const CameraMatrices& matrices);
+    void drawChunk(const Chunk& chunk);
+    void initIndirect();
+    void renderChunksIndirect(const std::vector<const Chunk*>& chunks);
+
+    static constexpr GLuint CAMERA_UBO_BINDING = 0;
+
     static GLuint VAO, VBO, EBO;
     static void   initBlockMesh();
     static bool   blockMeshInitialized;
-};
\ No newline at end of file
+};
@@ -1,5 +1,6 @@
 #include "shader.h"
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 #include <sstream>
@@ -29,6 +30,8 @@ Shader::Shader(const std::string& vertexPath, const std::string& fragmentPath)
     // Delete the shaders as they're linked into the program now and no longer needed
     glDeleteShader(vertexShader);
     glDeleteShader(fragmentShader);
+
+    reflectUniforms();
 }
 
 void Shader::use() const
@@ -38,62 +41,122 @@ void Shader::use() const
 
 void Shader::setBool(const std::string& name, bool value) const
 {
-    glUniform1i(glGetUniformLocation(ID, name.c_str()), static_cast<int>(value));
+    glUniform1i(getUniformLocation(name), static_cast<int>(value));
 }
 
 void Shader::setInt(const std::string& name, int value) const
 {
-    glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+    glUniform1i(getUniformLocation(name), value);
 }
 
 void Shader::setFloat(const std::string& name, float value) const
 {
-    glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+    glUniform1f(getUniformLocation(name), value);
 }
 
 void Shader::setVec2(const std::string& name, const glm::vec2& value) const
 {
-    glUniform2fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+    glUniform2fv(getUniformLocation(name), 1, &value[0]);
 }
 
 void Shader::setVec2(const std::string& name, float x, float y) const
 {
-    glUniform2f(glGetUniformLocation(ID, name.c_str()), x, y);
+    glUniform2f(getUniformLocation(name), x, y);
 }
 
 void Shader::setVec3(const std::string& name, const glm::vec3& value) const
 {
-    glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+    glUniform3fv(getUniformLocation(name), 1, &value[0]);
 }
 
 void Shader::setVec3(const std::string& name, float x, float y, float z) const
 {
-    glUniform3f(glGetUniformLocation(ID, name.c_str()), x, y, z);
+    glUniform3f(getUniformLocation(name), x, y, z);
 }
 
 void Shader::setVec4(const std::string& name, const glm::vec4& value) const
 {
-    glUniform4fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+    glUniform4fv(getUniformLocation(name), 1, &value[0]);
 }
 
 void Shader::setVec4(const std::string& name, float x, float y, float z, float w) const
 {
-    glUniform4f(glGetUniformLocation(ID, name.c_str()), x, y, z, w);
+    glUniform4f(getUniformLocation(name), x, y, z, w);
 }
 
 void Shader::setMat2(const std::string& name, const glm::mat2& mat) const
 {
-    glUniformMatrix2fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+    glUniformMatrix2fv(getUniformLocation(name), 1, GL_FALSE, &mat[0][0]);
 }
 
 void Shader::setMat3(const std::string& name, const glm::mat3& mat) const
 {
-    glUniformMatrix3fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+    glUniformMatrix3fv(getUniformLocation(name), 1, GL_FALSE, &mat[0][0]);
 }
 
 void Shader::setMat4(const std::string& name, const glm::mat4& mat) const
 {
-    glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+    glUniformMatrix4fv(getUniformLocation(name), 1, GL_FALSE, &mat[0][0]);
+}
+
+void Shader::setMat4(GLint location, const glm::mat4& mat) const
+{
+    glUniformMatrix4fv(location, 1, GL_FALSE, &mat[0][0]);
+}
+
+GLint Shader::getUniformLocation(const std::string& name) const
+{
+    auto it = uniformLocations.find(name);
+    return it != uniformLocations.end() ? it->second : -1;
+}
+
+void Shader::bindUniformBlock(const std::string& name, GLuint bindingPoint) const
+{
+    auto it = uniformBlockIndices.find(name);
+    if (it != uniformBlockIndices.end())
+        glUniformBlockBinding(ID, it->second, bindingPoint);
+}
+
+// Cache every active uniform location and uniform block index so setters never query GL by name
+void Shader::reflectUniforms()
+{
+    GLint maxNameLength = 0;
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+    GLint maxBlockNameLength = 0;
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &maxBlockNameLength);
+    std::string nameBuffer(std::max(maxNameLength, maxBlockNameLength), '\0');
+
+    GLint uniformCount = 0;
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &uniformCount);
+    for (GLint i = 0; i < uniformCount; ++i)
+    {
+        GLsizei length = 0;
+        GLint   size   = 0;
+        GLenum  type   = 0;
+        glGetActiveUniform(ID, i, static_cast<GLsizei>(nameBuffer.size()), &length, &size, &type,
+                           nameBuffer.data());
+        std::string name(nameBuffer.data(), length);
+
+        // Members of uniform blocks have no location
+        GLint location = glGetUniformLocation(ID, name.c_str());
+        if (location < 0)
+            continue;
+
+        // Arrays are reported as "name[0]"; also make them reachable by their plain name
+        if (name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0)
+            uniformLocations[name.substr(0, name.size() - 3)] = location;
+        uniformLocations[name] = location;
+    }
+
+    GLint blockCount = 0;
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORM_BLOCKS, &blockCount);
+    for (GLint i = 0; i < blockCount; ++i)
+    {
+        GLsizei length = 0;
+        glGetActiveUniformBlockName(ID, i, static_cast<GLsizei>(nameBuffer.size()), &length,
+                                    nameBuffer.data());
+        uniformBlockIndices[std::string(nameBuffer.data(), length)] = static_cast<GLuint>(i);
+    }
 }
 
 GLuint Shader::compileShader(const std::string& source, GLenum shaderType)
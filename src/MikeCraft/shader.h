@@ -4,6 +4,7 @@
 #include <glm/glm.hpp>
 
 #include <string>
+#include <unordered_map>
 
 class Shader
 {
@@ -14,6 +15,10 @@ class Shader
 
     void use() const;
 
+    // Locations are reflected once at link time; unknown names give -1 like glGetUniformLocation
+    GLint getUniformLocation(const std::string& name) const;
+    void  bindUniformBlock(const std::string& name, GLuint bindingPoint) const;
+
     // Utility functions to set uniform variables
     void setBool(const std::string& name, bool value) const;
     void setInt(const std::string& name, int value) const;
@@ -27,8 +32,13 @@ class Shader
     void setMat2(const std::string& name, const glm::mat2& mat) const;
     void setMat3(const std::string& name, const glm::mat3& mat) const;
     void setMat4(const std::string& name, const glm::mat4& mat) const;
+    void setMat4(GLint location, const glm::mat4& mat) const;
 
    private:
+    std::unordered_map<std::string, GLint>  uniformLocations;
+    std::unordered_map<std::string, GLuint> uniformBlockIndices;
+
+    void   reflectUniforms();
     GLuint compileShader(const std::string& source, GLenum shaderType);
 
     std::string readFile(const std::string& filePath);
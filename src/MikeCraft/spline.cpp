@@ -1,12 +1,18 @@
 #include "spline.h"
 
 #include <algorithm>
+#include <cmath>
+#include <stdexcept>
 
 void Spline::addPoint(float input, float output)
 {
     points.push_back({input, output});
     std::sort(points.begin(), points.end(),
               [](const SplinePoint& a, const SplinePoint& b) { return a.input < b.input; });
+
+    table = Table::NONE;
+    segments.clear();
+    values.clear();
 }
 
 float Spline::evaluate(float input) const
@@ -29,4 +35,142 @@ float Spline::evaluate(float input) const
         }
     }
     return points.back().output;  // Fallback, should not be reached
-}
\ No newline at end of file
+}
+
+void Spline::compile(float maxError)
+{
+    table = Table::NONE;
+    segments.clear();
+    values.clear();
+
+    // Splines with repeated inputs keep using evaluate()
+    if (points.size() < 2 || points.size() > UINT16_MAX)
+        return;
+    float range  = points.back().input - points.front().input;
+    float minGap = range;
+    for (size_t i = 1; i < points.size(); ++i)
+        minGap = std::min(minGap, points[i].input - points[i - 1].input);
+    if (minGap <= 0.0f)
+        return;
+
+    tableStart = points.front().input;
+
+    if (maxError > 0.0f)
+    {
+        // Interpolating the table is exact except in cells containing points, where it is off by
+        // at most a quarter of the cell width times the sum of their changes in slope. Half the
+        // bound is left for rounding.
+        std::vector<double> slopeChanges(points.size(), 0.0);
+        double              previousSlope = 0.0;
+        for (size_t i = 1; i < points.size(); ++i)
+        {
+            double slope = (static_cast<double>(points[i].output) - points[i - 1].output) /
+                           (static_cast<double>(points[i].input) - points[i - 1].input);
+            if (i > 1)
+                slopeChanges[i - 1] = std::abs(slope - previousSlope);
+            previousSlope = slope;
+        }
+
+        // Sized for the largest single change first, then shrunk until the points sharing a cell
+        // stay within the bound together. Every pass strictly grows the table.
+        double largestChange = *std::max_element(slopeChanges.begin(), slopeChanges.end());
+        double cells         = std::max(1.0, std::ceil(range * largestChange / (2.0 * maxError)));
+        while (true)
+        {
+            if (cells + 1 > MAX_TABLE_SIZE)
+                throw std::invalid_argument("Spline error bound needs too large a table");
+
+            std::vector<double> cellChanges(static_cast<size_t>(cells), 0.0);
+            for (size_t i = 1; i + 1 < points.size(); ++i)
+            {
+                double position = (points[i].input - tableStart) * cells / range;
+                size_t cell     = std::min(static_cast<size_t>(position), cellChanges.size() - 1);
+                cellChanges[cell] += slopeChanges[i];
+            }
+
+            double worstChange = *std::max_element(cellChanges.begin(), cellChanges.end());
+            double needed      = std::max(1.0, std::ceil(range * worstChange / (2.0 * maxError)));
+            if (needed <= cells)
+                break;
+            cells = needed;
+        }
+
+        size_t cellCount = static_cast<size_t>(cells);
+        tableScale       = cellCount / range;
+        values.resize(cellCount + 1);
+        for (size_t i = 0; i <= cellCount; ++i)
+            values[i] = evaluate(tableStart + range * i / cellCount);
+        values.back() = points.back().output;
+
+        table = Table::VALUES;
+        return;
+    }
+
+    // Buckets a quarter of the smallest gap wide, so the inputs that land in one bucket, rounding
+    // included, span at most one point and the segment is found with a single comparison
+    double buckets = std::ceil(range * 4.0 / minGap);
+    if (buckets > MAX_TABLE_SIZE)
+        return;
+
+    size_t bucketCount = static_cast<size_t>(buckets);
+    tableScale         = bucketCount / range;
+    segments.resize(bucketCount);
+    for (size_t b = 0; b < bucketCount; ++b)
+    {
+        // Half a bucket early to cover inputs that round into the bucket from below
+        float    start   = tableStart + (b - 0.5f) / tableScale;
+        uint16_t segment = 0;
+        while (segment + 2u < points.size() && points[segment + 1].input <= start)
+            ++segment;
+        segments[b] = segment;
+    }
+    table = Table::SEGMENTS;
+}
+
+void Spline::evaluateBatch(const float* inputs, float* outputs, size_t count) const
+{
+    if (table == Table::NONE)
+    {
+        for (size_t i = 0; i < count; ++i)
+            outputs[i] = evaluate(inputs[i]);
+        return;
+    }
+
+    const SplinePoint& first = points.front();
+    const SplinePoint& last  = points.back();
+
+    // Table positions are never negative once inputs are clamped, and int conversions are cheaper
+    if (table == Table::VALUES)
+    {
+        int lastCell = static_cast<int>(values.size()) - 2;
+        for (size_t i = 0; i < count; ++i)
+        {
+            float input    = std::min(std::max(inputs[i], first.input), last.input);
+            float position = (input - tableStart) * tableScale;
+            int   cell     = std::min(static_cast<int>(position), lastCell);
+            float t        = position - cell;
+            float value    = values[cell] + t * (values[cell + 1] - values[cell]);
+            value          = input <= first.input ? first.output : value;
+            outputs[i]     = input >= last.input ? last.output : value;
+        }
+        return;
+    }
+
+    int lastBucket  = static_cast<int>(segments.size()) - 1;
+    int lastSegment = static_cast<int>(points.size()) - 2;
+    for (size_t i = 0; i < count; ++i)
+    {
+        float input   = std::min(std::max(inputs[i], first.input), last.input);
+        int   bucket  = static_cast<int>((input - tableStart) * tableScale);
+        int   segment = segments[std::min(bucket, lastBucket)];
+        segment       = std::min(segment + (input >= points[segment + 1].input), lastSegment);
+
+        // Same arithmetic as evaluate(), with its exact endpoint outputs
+        const SplinePoint& p0    = points[segment];
+        const SplinePoint& p1    = points[segment + 1];
+        float              t     = (input - p0.input) / (p1.input - p0.input);
+        float              value = p0.output + t * (p1.output - p0.output);
+        value                    = input <= first.input ? first.output : value;
+        outputs[i]               = input >= last.input ? last.output : value;
+    }
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 
 struct SplinePoint
@@ -11,15 +13,39 @@ struct SplinePoint
 class Spline
 {
    public:
-    void addPoint(float input, float output);
+    // Tables larger than this are not built
+    static constexpr size_t MAX_TABLE_SIZE = 1 << 16;
+
+    void addPoint(float input, float output);  // Discards a compiled table
 
     float evaluate(float input) const;
 
+    // Prepares evaluateBatch. With maxError 0 inputs find their segment through a uniform table in
+    // one step and results match evaluate() exactly. Otherwise outputs are interpolated from a
+    // uniform table of values sized to stay within maxError of evaluate(), however closely the
+    // points are spaced; throws std::invalid_argument if that needs more than MAX_TABLE_SIZE
+    // entries. Inputs outside the points always give the exact end outputs.
+    void compile(float maxError = 0.0f);
+    // Falls back to evaluate() per input when not compiled
+    void evaluateBatch(const float* inputs, float* outputs, size_t count) const;
+
     const std::vector<SplinePoint>& getPoints() const
     {
         return points;
     }
 
    private:
+    enum class Table : uint8_t
+    {
+        NONE,
+        SEGMENTS,  // First segment each bucket of inputs can fall in
+        VALUES,    // Outputs at evenly spaced inputs
+    };
+
     std::vector<SplinePoint> points;
-};
\ No newline at end of file
+
+    Table                 table = Table::NONE;
+    float                 tableStart = 0.0f, tableScale = 0.0f;  // Input to table position
+    std::vector<uint16_t> segments;
+    std::vector<float>    values;
+};
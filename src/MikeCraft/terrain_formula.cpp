@@ -0,0 +1,171 @@
+#include "terrain_formula.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+void TerrainKernel::evaluateBatch(const std::array<const float*, NOISE_CHANNEL_COUNT>& channels,
+                                  float* outputs, size_t count) const
+{
+    if (instructions.empty())
+    {
+        std::fill(outputs, outputs + count, 0.0f);
+        return;
+    }
+
+    // One row of count values per instruction; noise instructions read their channel in place
+    std::vector<float>        scratch(instructions.size() * count);
+    std::vector<const float*> rows(instructions.size());
+    for (size_t i = 0; i < instructions.size(); ++i)
+    {
+        const Instruction& instruction = instructions[i];
+        float*             row         = &scratch[i * count];
+        rows[i]                        = row;
+
+        const float* a = rows[instruction.a];
+        const float* b = rows[instruction.b];
+        switch (instruction.op)
+        {
+            case Op::NOISE:
+                rows[i] = channels[static_cast<size_t>(instruction.channel)];
+                break;
+            case Op::CONSTANT:
+                std::fill(row, row + count, instruction.constant);
+                break;
+            case Op::SPLINE:
+                splines[instruction.spline].evaluateBatch(a, row, count);
+                break;
+            case Op::ADD:
+                for (size_t j = 0; j < count; ++j)
+                    row[j] = a[j] + b[j];
+                break;
+            case Op::MULTIPLY:
+                for (size_t j = 0; j < count; ++j)
+                    row[j] = a[j] * b[j];
+                break;
+        }
+    }
+    std::copy(rows.back(), rows.back() + count, outputs);
+}
+
+TerrainFormula::Node TerrainFormula::noise(NoiseChannel channel)
+{
+    if (channel >= NoiseChannel::COUNT)
+        throw std::out_of_range("Invalid noise channel");
+
+    TerrainKernel::Instruction node{};
+    node.op      = TerrainKernel::Op::NOISE;
+    node.channel = channel;
+    return addNode(node);
+}
+
+TerrainFormula::Node TerrainFormula::constant(float value)
+{
+    TerrainKernel::Instruction node{};
+    node.op       = TerrainKernel::Op::CONSTANT;
+    node.constant = value;
+    return addNode(node);
+}
+
+TerrainFormula::Node TerrainFormula::spline(const Spline& spline, Node input)
+{
+    checkInput(input);
+    splines.push_back(spline);
+
+    TerrainKernel::Instruction node{};
+    node.op     = TerrainKernel::Op::SPLINE;
+    node.a      = input;
+    node.spline = static_cast<uint16_t>(splines.size() - 1);
+    return addNode(node);
+}
+
+TerrainFormula::Node TerrainFormula::add(Node a, Node b)
+{
+    checkInput(a);
+    checkInput(b);
+
+    TerrainKernel::Instruction node{};
+    node.op = TerrainKernel::Op::ADD;
+    node.a  = a;
+    node.b  = b;
+    return addNode(node);
+}
+
+TerrainFormula::Node TerrainFormula::multiply(Node a, Node b)
+{
+    checkInput(a);
+    checkInput(b);
+
+    TerrainKernel::Instruction node{};
+    node.op = TerrainKernel::Op::MULTIPLY;
+    node.a  = a;
+    node.b  = b;
+    return addNode(node);
+}
+
+TerrainKernel TerrainFormula::compile(Node output, float splineMaxError) const
+{
+    checkInput(output);
+
+    // Inputs always come before their users, so one backward pass finds every node in use
+    std::vector<bool> used(output + 1, false);
+    used[output] = true;
+    for (int i = output; i >= 0; --i)
+    {
+        if (!used[i])
+            continue;
+
+        const TerrainKernel::Instruction& node = nodes[i];
+        if (node.op == TerrainKernel::Op::SPLINE)
+            used[node.a] = true;
+        else if (node.op == TerrainKernel::Op::ADD || node.op == TerrainKernel::Op::MULTIPLY)
+            used[node.a] = used[node.b] = true;
+    }
+
+    TerrainKernel         kernel;
+    std::vector<uint16_t> remap(output + 1, 0);
+    for (size_t i = 0; i <= output; ++i)
+    {
+        if (!used[i])
+            continue;
+        if (kernel.instructions.size() == TerrainKernel::MAX_INSTRUCTIONS)
+            throw std::length_error("Terrain formula has too many nodes");
+
+        TerrainKernel::Instruction instruction = nodes[i];
+
+        instruction.a = remap[instruction.a];
+        instruction.b = remap[instruction.b];
+
+        switch (instruction.op)
+        {
+            case TerrainKernel::Op::NOISE:
+                kernel.channelMask |= 1u << static_cast<uint32_t>(instruction.channel);
+                break;
+            case TerrainKernel::Op::SPLINE:
+                kernel.splines.push_back(splines[instruction.spline]);
+                kernel.splines.back().compile(splineMaxError);
+                instruction.spline = static_cast<uint16_t>(kernel.splines.size() - 1);
+                break;
+            default:
+                break;
+        }
+
+        remap[i] = static_cast<uint16_t>(kernel.instructions.size());
+        kernel.instructions.push_back(instruction);
+    }
+    return kernel;
+}
+
+TerrainFormula::Node TerrainFormula::addNode(const TerrainKernel::Instruction& node)
+{
+    if (nodes.size() > UINT16_MAX)
+        throw std::length_error("Terrain formula has too many nodes");
+
+    nodes.push_back(node);
+    return static_cast<Node>(nodes.size() - 1);
+}
+
+void TerrainFormula::checkInput(Node input) const
+{
+    if (input >= nodes.size())
+        throw std::out_of_range("Terrain formula node does not exist");
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "spline.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+enum class NoiseChannel : uint8_t
+{
+    CONTINENT,
+    EROSION,
+    PV,  // Peaks and valleys
+    COUNT
+};
+
+constexpr size_t NOISE_CHANNEL_COUNT = static_cast<size_t>(NoiseChannel::COUNT);
+
+// Flat program compiled from a TerrainFormula. It holds only the nodes the output depends on, each
+// after its inputs, and is run once per column.
+class TerrainKernel
+{
+   public:
+    static constexpr size_t MAX_INSTRUCTIONS = 64;
+
+    // Runs each instruction across all columns at once; channels the kernel does not use may be
+    // null. Outputs 0 for a kernel that was never compiled.
+    void evaluateBatch(const std::array<const float*, NOISE_CHANNEL_COUNT>& channels,
+                       float* outputs, size_t count) const;
+
+    // Channels that are never read do not need to be generated
+    bool usesChannel(NoiseChannel channel) const
+    {
+        return channelMask & (1u << static_cast<uint32_t>(channel));
+    }
+    uint32_t getChannelMask() const
+    {
+        return channelMask;
+    }
+
+   private:
+    friend class TerrainFormula;
+
+    enum class Op : uint8_t
+    {
+        NOISE,
+        CONSTANT,
+        SPLINE,
+        ADD,
+        MULTIPLY,
+    };
+
+    struct Instruction
+    {
+        Op           op;
+        NoiseChannel channel;   // NOISE
+        uint16_t     a, b;      // Earlier instructions; SPLINE reads a
+        uint16_t     spline;    // SPLINE
+        float        constant;  // CONSTANT
+    };
+
+    std::vector<Instruction> instructions;
+    std::vector<Spline>      splines;
+    uint32_t                 channelMask = 0;
+};
+
+// Terrain height as a small graph of noise channels, splines and arithmetic. Each node can only
+// take nodes created before it as inputs, so the graph never has cycles.
+class TerrainFormula
+{
+   public:
+    using Node = uint16_t;
+
+    Node noise(NoiseChannel channel);
+    Node constant(float value);
+    Node spline(const Spline& spline, Node input);
+    Node add(Node a, Node b);
+    Node multiply(Node a, Node b);
+
+    // Drops every node the output does not depend on and compiles the splines it keeps with the
+    // given error bound (see Spline::compile). Throws if the result would need more than
+    // TerrainKernel::MAX_INSTRUCTIONS.
+    TerrainKernel compile(Node output, float splineMaxError = 0.0f) const;
+
+   private:
+    std::vector<TerrainKernel::Instruction> nodes;
+    std::vector<Spline>                     splines;
+
+    Node addNode(const TerrainKernel::Instruction& node);
+    void checkInput(Node input) const;
+};
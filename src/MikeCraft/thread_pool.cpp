@@ -0,0 +1,123 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+
+namespace
+{
+    // Lets submit() recognize calls made from inside a task
+    thread_local const ThreadPool* currentPool  = nullptr;
+    thread_local size_t            currentIndex = 0;
+}  // namespace
+
+ThreadPool::ThreadPool(size_t threadCount)
+{
+    if (threadCount == 0)
+        threadCount = defaultThreadCount();
+
+    // Create every deque before any thread starts stealing from them
+    for (size_t i = 0; i < threadCount; ++i)
+        workers.push_back(std::make_unique<Worker>());
+    for (size_t i = 0; i < threadCount; ++i)
+        workers[i]->thread = std::thread(&ThreadPool::workerLoop, this, i);
+}
+
+ThreadPool::~ThreadPool()
+{
+    shutdown();
+}
+
+size_t ThreadPool::defaultThreadCount()
+{
+    unsigned int hardwareThreads = std::thread::hardware_concurrency();
+    return std::max<size_t>(1, hardwareThreads > 1 ? hardwareThreads - 1 : 1);
+}
+
+void ThreadPool::submit(Task task)
+{
+    size_t index = currentPool == this ? currentIndex : nextWorker++ % workers.size();
+
+    // Count the task before it becomes visible so a worker never takes more than was counted
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        if (stopping)
+            return;
+        ++pendingTasks;
+    }
+    {
+        std::lock_guard<std::mutex> lock(workers[index]->mutex);
+        workers[index]->tasks.push_back(std::move(task));
+    }
+    sleepCV.notify_one();
+}
+
+void ThreadPool::shutdown()
+{
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    sleepCV.notify_all();
+
+    for (auto& worker : workers)
+    {
+        if (worker->thread.joinable())
+            worker->thread.join();
+    }
+}
+
+void ThreadPool::workerLoop(size_t index)
+{
+    currentPool  = this;
+    currentIndex = index;
+
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            sleepCV.wait(lock, [&] { return pendingTasks > 0 || stopping; });
+            if (stopping)
+                return;
+        }
+
+        Task task;
+        if (!takeTask(index, task))
+            continue;  // Counted but not pushed yet, or another worker got there first
+
+        task();
+    }
+}
+
+bool ThreadPool::takeTask(size_t index, Task& task)
+{
+    auto claim = [&](Worker& worker, bool newest)
+    {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        if (worker.tasks.empty())
+            return false;
+
+        if (newest)
+        {
+            task = std::move(worker.tasks.back());
+            worker.tasks.pop_back();
+        }
+        else
+        {
+            task = std::move(worker.tasks.front());
+            worker.tasks.pop_front();
+        }
+
+        std::lock_guard<std::mutex> sleepLock(sleepMutex);
+        --pendingTasks;
+        return true;
+    };
+
+    if (claim(*workers[index], true))
+        return true;
+
+    for (size_t i = 1; i < workers.size(); ++i)
+    {
+        if (claim(*workers[(index + i) % workers.size()], false))
+            return true;
+    }
+    return false;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads, each with its own task deque. Workers run their own tasks newest
+// first and steal the oldest task from another worker when they run dry.
+class ThreadPool
+{
+   public:
+    using Task = std::function<void()>;
+
+    // A thread count of 0 picks defaultThreadCount()
+    explicit ThreadPool(size_t threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&)            = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Tasks submitted from a worker stay on that worker's deque
+    void submit(Task task);
+
+    // Stops and joins every worker; tasks that have not started are dropped
+    void shutdown();
+
+    size_t getThreadCount() const
+    {
+        return workers.size();
+    }
+
+    // One thread per hardware thread, leaving one for the main thread
+    static size_t defaultThreadCount();
+
+   private:
+    struct Worker
+    {
+        std::deque<Task> tasks;
+        std::mutex       mutex;
+        std::thread      thread;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::atomic<size_t>                  nextWorker{0};
+    size_t                               pendingTasks = 0;  // Submitted but not yet taken
+    bool                                 stopping     = false;
+    std::mutex                           sleepMutex;
+    std::condition_variable              sleepCV;
+
+    void workerLoop(size_t index);
+    bool takeTask(size_t index, Task& task);
+};
@@ -1,6 +1,23 @@
 #include "constants.h"
 #include "world_generator.h"
 
+#include <stdexcept>
+
+// interpolateField only matches getInterpolatedNoise bit for bit if neither path has its
+// multiply-adds fused, which GCC and Clang do by default when FMA instructions are available
+#if defined(__clang__)
+#pragma STDC FP_CONTRACT OFF
+#elif defined(__GNUC__)
+#pragma GCC optimize("fp-contract=off")
+#elif defined(_MSC_VER)
+#pragma fp_contract(off)
+#endif
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define MIKECRAFT_SSE
+#include <xmmintrin.h>
+#endif
+
 WorldGenerator::WorldGenerator(int seed)
 {
     continentPerlin  = FastNoise::New<FastNoise::Perlin>();
@@ -34,30 +51,147 @@ WorldGenerator::WorldGenerator(int seed)
     pvSpline.addPoint(-1.0f, 0.0f);
     pvSpline.addPoint(0.0f, 1.0f);
     pvSpline.addPoint(1.0f, 0.0f);
+
+    // Continentalness alone for now, so erosion and peaks and valleys are never generated. The
+    // earlier idea of continent * erosion + pv * 10 would be:
+    // add(multiply(continent, erosion), multiply(pv, constant(10)))
+    TerrainFormula formula;
+    TerrainFormula::Node continent =
+        formula.spline(continentSpline, formula.noise(NoiseChannel::CONTINENT));
+    setTerrainFormula(formula, continent);
 }
 
-void WorldGenerator::generateRegionNoiseGrids(std::vector<float>& continentGrid,
-                                              std::vector<float>& erosionGrid,
-                                              std::vector<float>& pvGrid, int regionX, int regionZ,
-                                              float frequency, int seed) const
+void WorldGenerator::setTerrainFormula(const TerrainFormula& formula, TerrainFormula::Node output,
+                                       float splineMaxError)
 {
-    continentGrid.resize(NOISE_GRID_SIZE * NOISE_GRID_SIZE);
-    erosionGrid.resize(NOISE_GRID_SIZE * NOISE_GRID_SIZE);
-    pvGrid.resize(NOISE_GRID_SIZE * NOISE_GRID_SIZE);
+    terrainKernel = formula.compile(output, splineMaxError);
+}
 
+void WorldGenerator::generateRegionNoiseGrids(NoiseChannelGrids& grids, int regionX, int regionZ,
+                                              float frequency, int seed) const
+{
     int startX = regionX * REGION_BLOCKS / NOISE_SAMPLE_STEP;
     int startZ = regionZ * REGION_BLOCKS / NOISE_SAMPLE_STEP;
+    generateNoiseGrids(grids, startX, startZ, NOISE_GRID_SIZE, frequency, seed);
+}
+
+void WorldGenerator::generateChunkNoiseGrids(NoiseChannelGrids& grids, int chunkX, int chunkZ,
+                                             float frequency, int seed) const
+{
+    int startX = chunkX * CHUNK_SIZE / NOISE_SAMPLE_STEP;
+    int startZ = chunkZ * CHUNK_SIZE / NOISE_SAMPLE_STEP;
+    generateNoiseGrids(grids, startX, startZ, CHUNK_NOISE_GRID_SIZE, frequency, seed);
+}
 
-    continentFractal->GenUniformGrid2D(continentGrid.data(), startX, startZ, NOISE_GRID_SIZE,
-                                       NOISE_GRID_SIZE, NOISE_SAMPLE_STEP * frequency, seed);
-    erosionFractal->GenUniformGrid2D(erosionGrid.data(), startX, startZ, NOISE_GRID_SIZE,
-                                     NOISE_GRID_SIZE, NOISE_SAMPLE_STEP * frequency, seed);
-    pvFractal->GenUniformGrid2D(pvGrid.data(), startX, startZ, NOISE_GRID_SIZE, NOISE_GRID_SIZE,
-                                NOISE_SAMPLE_STEP * frequency, seed);
+// Grids start at the given sample coordinates, so region and chunk grids share one lattice
+void WorldGenerator::generateNoiseGrids(NoiseChannelGrids& grids, int startX, int startZ, int size,
+                                        float frequency, int seed) const
+{
+    for (size_t i = 0; i < NOISE_CHANNEL_COUNT; ++i)
+    {
+        auto channel = static_cast<NoiseChannel>(i);
+        if (!terrainKernel.usesChannel(channel))
+        {
+            grids[i].clear();
+            continue;
+        }
+
+        grids[i].resize(size * size);
+        getChannelNoise(channel)->GenUniformGrid2D(grids[i].data(), startX, startZ, size, size,
+                                                   NOISE_SAMPLE_STEP * frequency, seed);
+    }
+}
+
+const FastNoise::Generator* WorldGenerator::getChannelNoise(NoiseChannel channel) const
+{
+    switch (channel)
+    {
+        case NoiseChannel::CONTINENT:
+            return continentFractal.get();
+        case NoiseChannel::EROSION:
+            return erosionFractal.get();
+        default:
+            return pvFractal.get();
+    }
+}
+
+// Interpolates only the channels the formula reads, then runs the kernel on all columns at once
+void WorldGenerator::generateHeights(const NoiseChannelGrids& grids, int gridSize, int originX,
+                                     int originZ,
+                                     std::array<float, CHUNK_SIZE * CHUNK_SIZE>& heights) const
+{
+    std::array<std::array<float, CHUNK_SIZE * CHUNK_SIZE>, NOISE_CHANNEL_COUNT> fields;
+    std::array<const float*, NOISE_CHANNEL_COUNT>                             channels{};
+    for (size_t i = 0; i < NOISE_CHANNEL_COUNT; ++i)
+    {
+        if (terrainKernel.usesChannel(static_cast<NoiseChannel>(i)))
+        {
+            if (grids[i].size() < static_cast<size_t>(gridSize * gridSize))
+                throw std::invalid_argument("Noise grids lack a channel the terrain formula uses");
+            interpolateField(grids[i], gridSize, originX, originZ, fields[i]);
+            channels[i] = fields[i].data();
+        }
+    }
+
+    terrainKernel.evaluateBatch(channels, heights.data(), heights.size());
+}
+
+void WorldGenerator::interpolateField(const std::vector<float>& grid, int gridSize, int originX,
+                                      int originZ,
+                                      std::array<float, CHUNK_SIZE * CHUNK_SIZE>& field) const
+{
+#ifdef MIKECRAFT_SSE
+    // With a step of 4 the columns of one grid cell fill one vector and the weights are constants
+    static_assert(NOISE_SAMPLE_STEP == 4, "One SSE vector covers the columns of a grid cell");
+    constexpr int CELLS = CHUNK_SIZE / NOISE_SAMPLE_STEP;
+
+    // The same operations in the same order as getInterpolatedNoise, so results match exactly
+    const __m128 towardNext = _mm_setr_ps(0.0f, 0.25f, 0.5f, 0.75f);
+    const __m128 towardThis = _mm_setr_ps(1.0f, 0.75f, 0.5f, 0.25f);
+
+    for (int cellZ = 0; cellZ < CELLS; ++cellZ)
+    {
+        int          firstSample = (originZ / NOISE_SAMPLE_STEP + cellZ) * gridSize;
+        const float* row0        = &grid[firstSample + originX / NOISE_SAMPLE_STEP];
+        const float* row1        = row0 + gridSize;
+
+        // Interpolated along x on the sample rows above and below this band of blocks
+        __m128 near[CELLS], far[CELLS];
+        for (int cell = 0; cell < CELLS; ++cell)
+        {
+            near[cell] = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(row0[cell]), towardThis),
+                                    _mm_mul_ps(_mm_set1_ps(row0[cell + 1]), towardNext));
+            far[cell]  = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(row1[cell]), towardThis),
+                                    _mm_mul_ps(_mm_set1_ps(row1[cell + 1]), towardNext));
+        }
+
+        for (int step = 0; step < NOISE_SAMPLE_STEP; ++step)
+        {
+            float  tz         = static_cast<float>(step) / NOISE_SAMPLE_STEP;
+            __m128 weightNear = _mm_set1_ps(1 - tz);
+            __m128 weightFar  = _mm_set1_ps(tz);
+            float* out        = &field[(cellZ * NOISE_SAMPLE_STEP + step) * CHUNK_SIZE];
+
+            for (int cell = 0; cell < CELLS; ++cell)
+            {
+                __m128 value = _mm_add_ps(_mm_mul_ps(near[cell], weightNear),
+                                          _mm_mul_ps(far[cell], weightFar));
+                _mm_storeu_ps(out + cell * NOISE_SAMPLE_STEP, value);
+            }
+        }
+    }
+#else
+    for (int z = 0; z < CHUNK_SIZE; ++z)
+    {
+        for (int x = 0; x < CHUNK_SIZE; ++x)
+            field[z * CHUNK_SIZE + x] =
+                getInterpolatedNoise(grid, originX + x, originZ + z, gridSize);
+    }
+#endif
 }
 
-float WorldGenerator::getInterpolatedNoise(const std::vector<float>& grid, int blockX,
-                                           int blockZ) const
+float WorldGenerator::getInterpolatedNoise(const std::vector<float>& grid, int blockX, int blockZ,
+                                           int gridSize) const
 {
     float gx = static_cast<float>(blockX) / NOISE_SAMPLE_STEP;
     float gz = static_cast<float>(blockZ) / NOISE_SAMPLE_STEP;
@@ -69,10 +203,10 @@ float WorldGenerator::getInterpolatedNoise(const std::vector<float>& grid, int b
     float tz = gz - iz;
 
     // Bilinear interpolation
-    float q11 = grid[iz * NOISE_GRID_SIZE + ix];
-    float q21 = grid[iz * NOISE_GRID_SIZE + ix + 1];
-    float q12 = grid[(iz + 1) * NOISE_GRID_SIZE + ix];
-    float q22 = grid[(iz + 1) * NOISE_GRID_SIZE + ix + 1];
+    float q11 = grid[iz * gridSize + ix];
+    float q21 = grid[iz * gridSize + ix + 1];
+    float q12 = grid[(iz + 1) * gridSize + ix];
+    float q22 = grid[(iz + 1) * gridSize + ix + 1];
 
     float interpX1 = q11 * (1 - tx) + q21 * tx;
     float interpX2 = q12 * (1 - tx) + q22 * tx;
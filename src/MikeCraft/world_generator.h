@@ -1,18 +1,51 @@
 #pragma once
 
+#include "constants.h"
 #include "spline.h"
+#include "terrain_formula.h"
 
 #include <FastNoise/FastNoise.h>
 
+#include <array>
+#include <vector>
+
+// One grid of samples per noise channel; channels the terrain formula does not use stay empty
+using NoiseChannelGrids = std::array<std::vector<float>, NOISE_CHANNEL_COUNT>;
+
 class WorldGenerator
 {
    public:
     WorldGenerator(int seed = 0);
 
-    void  generateRegionNoiseGrids(std::vector<float>& continentGrid,
-                                   std::vector<float>& erosionGrid, std::vector<float>& pvGrid,
-                                   int regionX, int regionZ, float frequency, int seed) const;
-    float getInterpolatedNoise(const std::vector<float>& grid, int blockX, int blockZ) const;
+    // Replaces the height formula; not safe while chunks are generating. Noise grids cached for
+    // the old formula are not reused. Splines are evaluated exactly unless splineMaxError allows
+    // them an approximating table.
+    void                 setTerrainFormula(const TerrainFormula& formula,
+                                           TerrainFormula::Node  output,
+                                           float                 splineMaxError = 0.0f);
+    const TerrainKernel& getTerrainKernel() const
+    {
+        return terrainKernel;
+    }
+
+    // Only the channels the terrain formula uses are generated
+    void  generateRegionNoiseGrids(NoiseChannelGrids& grids, int regionX, int regionZ,
+                                   float frequency, int seed) const;
+    // Same samples as the region grids give for this chunk, CHUNK_NOISE_GRID_SIZE squared
+    void  generateChunkNoiseGrids(NoiseChannelGrids& grids, int chunkX, int chunkZ, float frequency,
+                                  int seed) const;
+    // Block coordinates are relative to the grid's first sample. Reference for interpolateField.
+    float getInterpolatedNoise(const std::vector<float>& grid, int blockX, int blockZ,
+                               int gridSize = NOISE_GRID_SIZE) const;
+    // getInterpolatedNoise for all columns of a chunk at once, x fastest, bit for bit the same.
+    // The origin must lie on a grid sample, as chunk origins do.
+    void  interpolateField(const std::vector<float>& grid, int gridSize, int originX, int originZ,
+                           std::array<float, CHUNK_SIZE * CHUNK_SIZE>& field) const;
+
+    // Terrain height of each column of a chunk, x fastest, with the chunk's first block at
+    // (originX, originZ) in the grids
+    void generateHeights(const NoiseChannelGrids& grids, int gridSize, int originX, int originZ,
+                         std::array<float, CHUNK_SIZE * CHUNK_SIZE>& heights) const;
 
     Spline continentSpline;
     Spline erosionSpline;
@@ -25,4 +58,10 @@ class WorldGenerator
     FastNoise::SmartNode<FastNoise::FractalFBm>      erosionFractal;
     FastNoise::SmartNode<FastNoise::Perlin>          pvPerlin;
     FastNoise::SmartNode<FastNoise::FractalPingPong> pvFractal;
-};
\ No newline at end of file
+
+    TerrainKernel terrainKernel;
+
+    const FastNoise::Generator* getChannelNoise(NoiseChannel channel) const;
+    void                        generateNoiseGrids(NoiseChannelGrids& grids, int startX, int startZ,
+                                                   int size, float frequency, int seed) const;
+};
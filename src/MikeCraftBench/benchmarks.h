@@ -0,0 +1,18 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// Each benchmark takes the arguments after its name and returns the process exit code
+int runRegionIOBenchmark(int argc, char** argv);
+int runNoiseModeBenchmark(int argc, char** argv);
+int runInterpolationBenchmark(int argc, char** argv);
+
+// Value following --name in the arguments, or fallback if it is missing
+int getIntOption(int argc, char** argv, const std::string& name, int fallback);
+
+double getMedian(std::vector<double> values);
+
+// Empty scratch folder next to the executable, so benchmarks never touch the real world folder
+std::filesystem::path makeBenchDirectory(const std::string& name);
@@ -0,0 +1,90 @@
+#include "benchmarks.h"
+#include "constants.h"
+#include "world_generator.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    // Fields of every chunk origin in the region, interpolated column by column
+    void interpolateScalar(const WorldGenerator& generator, const std::vector<float>& grid,
+                           std::array<float, CHUNK_SIZE * CHUNK_SIZE>& field, float& checksum)
+    {
+        for (int chunk = 0; chunk < REGION_SIZE * REGION_SIZE; ++chunk)
+        {
+            int originX = chunk % REGION_SIZE * CHUNK_SIZE;
+            int originZ = chunk / REGION_SIZE * CHUNK_SIZE;
+            for (int z = 0; z < CHUNK_SIZE; ++z)
+            {
+                for (int x = 0; x < CHUNK_SIZE; ++x)
+                    field[z * CHUNK_SIZE + x] =
+                        generator.getInterpolatedNoise(grid, originX + x, originZ + z);
+            }
+            checksum += field[chunk % field.size()];
+        }
+    }
+
+    void interpolateBatched(const WorldGenerator& generator, const std::vector<float>& grid,
+                            std::array<float, CHUNK_SIZE * CHUNK_SIZE>& field, float& checksum)
+    {
+        for (int chunk = 0; chunk < REGION_SIZE * REGION_SIZE; ++chunk)
+        {
+            generator.interpolateField(grid, NOISE_GRID_SIZE, chunk % REGION_SIZE * CHUNK_SIZE,
+                                       chunk / REGION_SIZE * CHUNK_SIZE, field);
+            checksum += field[chunk % field.size()];
+        }
+    }
+}  // namespace
+
+// Nanoseconds per chunk field for getInterpolatedNoise column by column and for interpolateField
+int runInterpolationBenchmark(int argc, char** argv)
+{
+    int rounds     = getIntOption(argc, argv, "rounds", 5);
+    int iterations = 20;  // Passes over the region per round
+
+    WorldGenerator     generator(0);
+    std::vector<float> grid(NOISE_GRID_SIZE * NOISE_GRID_SIZE);
+
+    std::mt19937                          random(1);
+    std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+    for (float& sample : grid)
+        sample = value(random);
+
+    using Interpolate = void (*)(const WorldGenerator&, const std::vector<float>&,
+                                 std::array<float, CHUNK_SIZE * CHUNK_SIZE>&, float&);
+    const std::pair<Interpolate, const char*> variants[] = {
+        {interpolateScalar, "scalar"},
+        {interpolateBatched, "batched"},
+    };
+    std::vector<double>                        nanoseconds[2];
+    std::array<float, CHUNK_SIZE * CHUNK_SIZE> field;
+    float                                      checksum = 0.0f;  // Keeps the work observable
+
+    double fields = static_cast<double>(iterations) * REGION_SIZE * REGION_SIZE;
+    std::cout << std::fixed << std::setprecision(1);
+    for (int round = 0; round < rounds; ++round)
+    {
+        for (size_t i = 0; i < 2; ++i)
+        {
+            auto start = Clock::now();
+            for (int iteration = 0; iteration < iterations; ++iteration)
+                variants[i].first(generator, grid, field, checksum);
+            double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+            nanoseconds[i].push_back(seconds * 1e9 / fields);
+            std::cout << std::setw(7) << variants[i].second << " round " << round + 1 << ": "
+                      << nanoseconds[i].back() << " ns per field" << std::endl;
+        }
+    }
+
+    double scalar  = getMedian(nanoseconds[0]);
+    double batched = getMedian(nanoseconds[1]);
+    std::cout << "median: scalar " << scalar << " ns, batched " << batched << " ns, "
+              << scalar / batched << "x (checksum " << checksum << ")" << std::endl;
+    return 0;
+}
@@ -0,0 +1,71 @@
+#include "benchmarks.h"
+#include "file_utils.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <string_view>
+
+namespace
+{
+    struct Benchmark
+    {
+        const char* name;
+        const char* description;
+        int (*run)(int argc, char** argv);
+    };
+
+    constexpr Benchmark benchmarks[] = {
+        {"region-io", "chunk loads from region files with a cold page cache", runRegionIOBenchmark},
+        {"noise-modes", "first chunk and generation throughput per noise mode",
+         runNoiseModeBenchmark},
+        {"interpolation", "chunk noise fields, scalar vs batched SSE", runInterpolationBenchmark},
+    };
+}  // namespace
+
+int getIntOption(int argc, char** argv, const std::string& name, int fallback)
+{
+    for (int i = 0; i + 1 < argc; ++i)
+    {
+        if (argv[i] == "--" + name)
+            return std::atoi(argv[i + 1]);
+    }
+    return fallback;
+}
+
+double getMedian(std::vector<double> values)
+{
+    if (values.empty())
+        return 0.0;
+
+    std::sort(values.begin(), values.end());
+    size_t middle = values.size() / 2;
+    return values.size() % 2 ? values[middle] : (values[middle - 1] + values[middle]) / 2;
+}
+
+std::filesystem::path makeBenchDirectory(const std::string& name)
+{
+    std::filesystem::path directory =
+        std::filesystem::path(getExecutableDir()) / "bench_worlds" / name;
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    return directory;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc >= 2)
+    {
+        for (const Benchmark& benchmark : benchmarks)
+        {
+            if (std::string_view(argv[1]) == benchmark.name)
+                return benchmark.run(argc - 2, argv + 2);
+        }
+    }
+
+    std::cout << "Usage: MikeCraftBench <benchmark> [--radius chunks] [--rounds count]"
+              << std::endl;
+    for (const Benchmark& benchmark : benchmarks)
+        std::cout << "  " << benchmark.name << ": " << benchmark.description << std::endl;
+    return 1;
+}
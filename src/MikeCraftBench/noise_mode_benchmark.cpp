@@ -0,0 +1,89 @@
+#include "benchmarks.h"
+#include "chunk_manager.h"
+#include "world_generator.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    struct GenerationTimes
+    {
+        double firstChunk;  // Seconds until the first chunk is ready
+        double allChunks;   // Seconds until the whole square is ready
+    };
+
+    // Generates the square around the origin, which touches four regions, with no noise cached
+    // and no region files to load from
+    GenerationTimes generateChunks(WorldGenerator& generator,
+                                   const std::filesystem::path& directory, int radius,
+                                   NoiseMode mode)
+    {
+        ChunkManager manager(generator);
+        manager.setWorldDirectory(directory.string());
+        manager.setNoiseMode(mode);
+
+        size_t          chunkCount = static_cast<size_t>((2 * radius + 1) * (2 * radius + 1));
+        GenerationTimes times{};
+        auto            start = Clock::now();
+
+        // Nothing takes the chunks off the ready queue, so no meshing or GPU work is timed
+        manager.updateChunksAroundPlayer(0.0f, 0.0f, radius);
+        size_t ready = 0;
+        while (ready < chunkCount)
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+            ready = manager.getChunkCount(ChunkState::READY);
+            if (ready > 0 && times.firstChunk == 0.0)
+                times.firstChunk = std::chrono::duration<double>(Clock::now() - start).count();
+        }
+        times.allChunks = std::chrono::duration<double>(Clock::now() - start).count();
+        return times;
+    }
+}  // namespace
+
+// Time to the first chunk and overall generation throughput with region-wide and per-chunk noise
+int runNoiseModeBenchmark(int argc, char** argv)
+{
+    int radius = getIntOption(argc, argv, "radius", 12);
+    int rounds = getIntOption(argc, argv, "rounds", 5);
+    int chunks = (2 * radius + 1) * (2 * radius + 1);
+
+    WorldGenerator        generator(0);
+    std::filesystem::path directory = makeBenchDirectory("noise_modes");
+
+    const std::pair<NoiseMode, const char*> modes[] = {
+        {NoiseMode::REGION, "region"},
+        {NoiseMode::CHUNK, "chunk"},
+    };
+    std::vector<double> firstChunk[2], rates[2];
+
+    std::cout << chunks << " generated chunks, " << rounds << " rounds" << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+    for (int round = 0; round < rounds; ++round)
+    {
+        for (size_t i = 0; i < 2; ++i)
+        {
+            GenerationTimes times = generateChunks(generator, directory, radius, modes[i].first);
+            firstChunk[i].push_back(times.firstChunk * 1000.0);
+            rates[i].push_back(chunks / times.allChunks);
+            std::cout << std::setw(6) << modes[i].second << " round " << round + 1
+                      << ": first chunk " << firstChunk[i].back() << " ms, "
+                      << rates[i].back() << " chunks/s" << std::endl;
+        }
+    }
+
+    for (size_t i = 0; i < 2; ++i)
+    {
+        std::cout << std::setw(6) << modes[i].second << " median: first chunk "
+                  << getMedian(firstChunk[i]) << " ms, " << getMedian(rates[i]) << " chunks/s"
+                  << std::endl;
+    }
+
+    std::filesystem::remove_all(directory);
+    return 0;
+}
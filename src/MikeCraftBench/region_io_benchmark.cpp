@@ -0,0 +1,154 @@
+#include "benchmarks.h"
+#include "chunk_manager.h"
+#include "constants.h"
+#include "region_file.h"
+#include "world_generator.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <thread>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    // Terrain settings of the saved chunks; they only need to look like real ones
+    constexpr float noiseFrequency = 0.01f;
+    constexpr int   noiseSeed      = 0;
+
+    int toRegion(int chunkCoordinate)
+    {
+        return static_cast<int>(std::floor(static_cast<double>(chunkCoordinate) / REGION_SIZE));
+    }
+
+    // Saves every chunk of the square around the origin with generated terrain
+    void writeChunks(const WorldGenerator& generator, const std::filesystem::path& directory,
+                     int radius)
+    {
+        std::map<std::pair<int, int>, std::unique_ptr<RegionFile>> regions;
+        std::map<std::pair<int, int>, NoiseChannelGrids>          grids;
+
+        for (int chunkX = -radius; chunkX <= radius; ++chunkX)
+        {
+            for (int chunkZ = -radius; chunkZ <= radius; ++chunkZ)
+            {
+                auto key = std::make_pair(toRegion(chunkX), toRegion(chunkZ));
+                if (!regions.count(key))
+                {
+                    std::string filename = "r." + std::to_string(key.first) + "." +
+                                           std::to_string(key.second) + ".mca";
+                    regions[key] = std::make_unique<RegionFile>((directory / filename).string());
+                    generator.generateRegionNoiseGrids(grids[key], key.first, key.second,
+                                                       noiseFrequency, noiseSeed);
+                }
+
+                std::array<float, CHUNK_SIZE * CHUNK_SIZE> heights;
+                generator.generateHeights(grids[key], NOISE_GRID_SIZE,
+                                          (chunkX & (REGION_SIZE - 1)) * Chunk::WIDTH,
+                                          (chunkZ & (REGION_SIZE - 1)) * Chunk::DEPTH, heights);
+
+                Chunk chunk(chunkX, chunkZ);
+                for (int x = 0; x < Chunk::WIDTH; ++x)
+                {
+                    for (int z = 0; z < Chunk::DEPTH; ++z)
+                    {
+                        int blockY = static_cast<int>(heights[z * CHUNK_SIZE + x]);
+                        for (int y = 0; y < blockY && y < Chunk::HEIGHT; ++y)
+                        {
+                            Block::Id id = Block::Id::DIRT;
+                            if (y == blockY - 1)
+                                id = Block::Id::GRASS;
+                            if (y < blockY - 5)
+                                id = Block::Id::STONE;
+                            chunk.setBlock(x, y, z, Block(id));
+                        }
+                    }
+                }
+                chunk.compactSections();
+                regions[key]->saveChunk(chunk);
+            }
+        }
+    }
+
+    // Best effort: evicts the file from the OS page cache so its next reads go to the disk
+    void dropFileCache(const std::filesystem::path& path)
+    {
+#ifdef _WIN32
+        // Opening a file unbuffered makes the cache manager flush and purge its cached pages
+        HANDLE handle = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE,
+                                    nullptr, OPEN_EXISTING, FILE_FLAG_NO_BUFFERING, nullptr);
+        if (handle != INVALID_HANDLE_VALUE)
+            CloseHandle(handle);
+#else
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            return;
+        fsync(fd);  // Dirty pages cannot be dropped
+#ifdef POSIX_FADV_DONTNEED
+        posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+#endif
+        close(fd);
+#endif
+    }
+
+    // Seconds until every chunk of the square is read and decompressed
+    double loadChunks(WorldGenerator& generator, const std::filesystem::path& directory,
+                      int radius)
+    {
+        ChunkManager manager(generator);
+        manager.setWorldDirectory(directory.string());
+
+        size_t chunkCount = static_cast<size_t>((2 * radius + 1) * (2 * radius + 1));
+        auto   start      = Clock::now();
+
+        // Nothing takes the chunks off the ready queue, so no meshing or GPU work is timed
+        manager.updateChunksAroundPlayer(0.0f, 0.0f, radius);
+        while (manager.getChunkCount(ChunkState::READY) < chunkCount)
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+}  // namespace
+
+// Loads the same saved chunks with the page cache dropped before every round, so they are read
+// from the disk
+int runRegionIOBenchmark(int argc, char** argv)
+{
+    int radius = getIntOption(argc, argv, "radius", 12);
+    int rounds = getIntOption(argc, argv, "rounds", 5);
+    int chunks = (2 * radius + 1) * (2 * radius + 1);
+
+    WorldGenerator        generator(0);
+    std::filesystem::path directory = makeBenchDirectory("region_io");
+    writeChunks(generator, directory, radius);
+
+    std::vector<double> rates;
+
+    std::cout << chunks << " saved chunks, " << rounds << " rounds" << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+    for (int round = 0; round < rounds; ++round)
+    {
+        for (const auto& entry : std::filesystem::directory_iterator(directory))
+            dropFileCache(entry.path());
+
+        double seconds = loadChunks(generator, directory, radius);
+        rates.push_back(chunks / seconds);
+        std::cout << "round " << round + 1 << ": " << seconds * 1000.0 << " ms, " << rates.back()
+                  << " chunks/s" << std::endl;
+    }
+    std::cout << "median: " << getMedian(rates) << " chunks/s" << std::endl;
+
+    std::filesystem::remove_all(directory);
+    return 0;
+}
@@ -0,0 +1,72 @@
+#include "constants.h"
+#include "test.h"
+#include "world_generator.h"
+
+#include <random>
+#include <string>
+
+namespace
+{
+    // Mixes small and large magnitudes so any change in rounding shows up
+    std::vector<float> makeRandomGrid(int gridSize, unsigned seed)
+    {
+        std::mt19937                          random(seed);
+        std::uniform_real_distribution<float> value(-1.0f, 1.0f);
+
+        std::vector<float> grid(gridSize * gridSize);
+        for (float& sample : grid)
+            sample = value(random) * (random() % 2 ? 1000.0f : 1.0f);
+        return grid;
+    }
+
+    // Compares every column of the chunk at (originX, originZ) with ==
+    void checkFieldMatchesScalar(const WorldGenerator& generator, const std::vector<float>& grid,
+                                 int gridSize, int originX, int originZ)
+    {
+        std::array<float, CHUNK_SIZE * CHUNK_SIZE> field;
+        generator.interpolateField(grid, gridSize, originX, originZ, field);
+
+        for (int z = 0; z < CHUNK_SIZE; ++z)
+        {
+            for (int x = 0; x < CHUNK_SIZE; ++x)
+            {
+                float expected =
+                    generator.getInterpolatedNoise(grid, originX + x, originZ + z, gridSize);
+                float actual = field[z * CHUNK_SIZE + x];
+                if (actual != expected)
+                {
+                    reportFailure(__FILE__, __LINE__,
+                                  "interpolateField differs at block (" +
+                                      std::to_string(originX + x) + ", " +
+                                      std::to_string(originZ + z) + "): " +
+                                      std::to_string(actual) + " instead of " +
+                                      std::to_string(expected));
+                    return;  // One report per chunk is enough
+                }
+            }
+        }
+    }
+}  // namespace
+
+TEST_CASE(interpolateFieldMatchesScalarOnRegionGrid)
+{
+    WorldGenerator     generator(0);
+    std::vector<float> grid = makeRandomGrid(NOISE_GRID_SIZE, 1);
+
+    for (int chunkZ = 0; chunkZ < REGION_SIZE; ++chunkZ)
+    {
+        for (int chunkX = 0; chunkX < REGION_SIZE; ++chunkX)
+            checkFieldMatchesScalar(generator, grid, NOISE_GRID_SIZE, chunkX * CHUNK_SIZE,
+                                    chunkZ * CHUNK_SIZE);
+    }
+}
+
+TEST_CASE(interpolateFieldMatchesScalarOnChunkGrid)
+{
+    WorldGenerator generator(0);
+    for (unsigned seed = 0; seed < 64; ++seed)
+    {
+        std::vector<float> grid = makeRandomGrid(CHUNK_NOISE_GRID_SIZE, seed);
+        checkFieldMatchesScalar(generator, grid, CHUNK_NOISE_GRID_SIZE, 0, 0);
+    }
+}
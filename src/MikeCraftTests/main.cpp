@@ -0,0 +1,38 @@
+#include "test.h"
+
+#include <iostream>
+
+namespace
+{
+    int failedChecks = 0;
+}  // namespace
+
+std::vector<TestCase>& getTestCases()
+{
+    static std::vector<TestCase> testCases;
+    return testCases;
+}
+
+void reportFailure(const char* file, int line, const std::string& message)
+{
+    std::cout << file << "(" << line << "): " << message << std::endl;
+    ++failedChecks;
+}
+
+int main()
+{
+    int failedCases = 0;
+    for (const TestCase& testCase : getTestCases())
+    {
+        int failedBefore = failedChecks;
+        testCase.run();
+
+        bool passed = failedChecks == failedBefore;
+        failedCases += !passed;
+        std::cout << (passed ? "[ ok ] " : "[FAIL] ") << testCase.name << std::endl;
+    }
+
+    std::cout << getTestCases().size() - failedCases << " of " << getTestCases().size()
+              << " test cases passed" << std::endl;
+    return failedCases == 0 ? 0 : 1;
+}
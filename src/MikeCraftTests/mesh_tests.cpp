@@ -0,0 +1,118 @@
+#include "chunk.h"
+#include "chunk_neighborhood.h"
+#include "test.h"
+
+#include <algorithm>
+#include <array>
+#include <random>
+#include <string>
+
+namespace
+{
+    using Quad = std::array<GLuint, 4>;
+
+    // Uneven terrain columns with holes punched into them, in three block types so greedy quads
+    // break at tile changes
+    Chunk makeRandomChunk(int chunkX, int chunkZ, unsigned seed)
+    {
+        std::mt19937                    random(seed);
+        std::uniform_int_distribution<> height(1, 40);
+        std::uniform_int_distribution<> type(1, 3);
+
+        const Block::Id types[] = {Block::Id::AIR, Block::Id::GRASS, Block::Id::DIRT,
+                                   Block::Id::STONE};
+
+        Chunk chunk(chunkX, chunkZ);
+        for (int z = 0; z < Chunk::DEPTH; ++z)
+        {
+            for (int x = 0; x < Chunk::WIDTH; ++x)
+            {
+                int top = height(random);
+                for (int y = 0; y < top; ++y)
+                {
+                    if (random() % 8 != 0)
+                        chunk.setBlock(x, y, z, Block(types[type(random)]));
+                }
+            }
+        }
+        chunk.compactSections();
+        return chunk;
+    }
+
+    // Neighbors on the sides whose bit is set in presentSides (LEFT, RIGHT, BACK, FRONT)
+    std::shared_ptr<const ChunkNeighborhood> makeNeighborhood(unsigned presentSides,
+                                                              unsigned seed)
+    {
+        const Direction sides[4] = {Direction::LEFT, Direction::RIGHT, Direction::BACK,
+                                    Direction::FRONT};
+
+        auto neighborhood = std::make_shared<ChunkNeighborhood>();
+        for (int i = 0; i < 4; ++i)
+        {
+            if (presentSides & (1u << i))
+                neighborhood->captureNeighbor(sides[i], makeRandomChunk(0, 0, seed * 4 + i));
+        }
+        return neighborhood;
+    }
+
+    // Quads in a canonical order; meshes that differ only in quad order draw the same
+    std::vector<Quad> getSortedQuads(const ChunkMesh& mesh)
+    {
+        std::vector<Quad> quads(mesh.getQuadCount());
+        for (size_t i = 0; i < quads.size(); ++i)
+            std::copy_n(mesh.vertices.begin() + i * 4, 4, quads[i].begin());
+        std::sort(quads.begin(), quads.end());
+        return quads;
+    }
+}  // namespace
+
+TEST_CASE(remeshBordersMatchesFullRemesh)
+{
+    for (MeshingMode mode : {MeshingMode::GREEDY, MeshingMode::PER_FACE})
+    {
+        for (unsigned seed = 0; seed < 16; ++seed)
+        {
+            Chunk chunk = makeRandomChunk(0, 0, seed);
+
+            // Every change of neighbor set, including the same sides with different blocks
+            for (unsigned before = 0; before < 16; ++before)
+            {
+                unsigned after = (before * 7 + seed) % 16;
+
+                ChunkMesh cached = chunk.generateMesh(*makeNeighborhood(before, seed), mode);
+                cached.neighbors = makeNeighborhood(before, seed);
+
+                auto      neighbors = makeNeighborhood(after, seed + 1);
+                ChunkMesh expected  = chunk.generateMesh(*neighbors, mode);
+                ChunkMesh actual    = chunk.remeshBorders(cached, *neighbors, mode);
+
+                if (getSortedQuads(actual) != getSortedQuads(expected) ||
+                    actual.minY != expected.minY || actual.maxY != expected.maxY)
+                {
+                    reportFailure(__FILE__, __LINE__,
+                                  "seed " + std::to_string(seed) + ", sides " +
+                                      std::to_string(before) + " -> " + std::to_string(after) +
+                                      ": " + std::to_string(actual.getQuadCount()) +
+                                      " quads instead of " +
+                                      std::to_string(expected.getQuadCount()));
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE(remeshBordersKeepsMeshWithUnchangedNeighbors)
+{
+    Chunk chunk     = makeRandomChunk(0, 0, 1);
+    auto  neighbors = makeNeighborhood(0b0101, 1);
+
+    ChunkMesh cached = chunk.generateMesh(*neighbors);
+    cached.neighbors = neighbors;
+
+    // A missing neighbor and one with an empty border hide the same faces
+    auto withEmptyNeighbor = std::make_shared<ChunkNeighborhood>(*neighbors);
+    withEmptyNeighbor->captureNeighbor(Direction::RIGHT, Chunk(1, 0));
+
+    CHECK(chunk.remeshBorders(cached, *neighbors).vertices == cached.vertices);
+    CHECK(chunk.remeshBorders(cached, *withEmptyNeighbor).vertices == cached.vertices);
+}
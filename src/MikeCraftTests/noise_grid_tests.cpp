@@ -0,0 +1,114 @@
+#include "constants.h"
+#include "test.h"
+#include "world_generator.h"
+
+#include <cmath>
+#include <string>
+
+namespace
+{
+    // Same frequency and seed as ChunkManager
+    constexpr float frequency = 0.01f;
+    constexpr int   seed      = 0;
+
+    // Chunks at region corners and edges on both sides of the origin, plus a few inside
+    const int chunkCoordinates[][2] = {
+        {0, 0},     {31, 0},   {0, 31},  {31, 31},  {-1, -1}, {-32, -32}, {-33, 0},
+        {-1, 32},   {32, -33}, {5, -17}, {-20, 13}, {64, 95}, {-65, -96},
+    };
+
+    // Reads all three channels, so every grid is generated and interpolated
+    WorldGenerator makeGenerator()
+    {
+        WorldGenerator generator(seed);
+
+        TerrainFormula       formula;
+        TerrainFormula::Node continent =
+            formula.spline(generator.continentSpline, formula.noise(NoiseChannel::CONTINENT));
+        TerrainFormula::Node erosion = formula.noise(NoiseChannel::EROSION);
+        TerrainFormula::Node pv      = formula.noise(NoiseChannel::PV);
+        TerrainFormula::Node height  = formula.add(formula.multiply(continent, erosion),
+                                                   formula.multiply(pv, formula.constant(10.0f)));
+        generator.setTerrainFormula(formula, height);
+        return generator;
+    }
+
+    int floorDiv(int value, int divisor)
+    {
+        return static_cast<int>(std::floor(static_cast<double>(value) / divisor));
+    }
+
+    std::string describeChunk(int chunkX, int chunkZ)
+    {
+        return "chunk (" + std::to_string(chunkX) + ", " + std::to_string(chunkZ) + ")";
+    }
+}  // namespace
+
+TEST_CASE(chunkNoiseGridsMatchRegionGrids)
+{
+    WorldGenerator generator = makeGenerator();
+
+    for (const auto& [chunkX, chunkZ] : chunkCoordinates)
+    {
+        NoiseChannelGrids regionGrids, chunkGrids;
+        generator.generateRegionNoiseGrids(regionGrids, floorDiv(chunkX, REGION_SIZE),
+                                           floorDiv(chunkZ, REGION_SIZE), frequency, seed);
+        generator.generateChunkNoiseGrids(chunkGrids, chunkX, chunkZ, frequency, seed);
+
+        // First sample of the chunk within the region grid
+        int startX = (chunkX & (REGION_SIZE - 1)) * CHUNK_SIZE / NOISE_SAMPLE_STEP;
+        int startZ = (chunkZ & (REGION_SIZE - 1)) * CHUNK_SIZE / NOISE_SAMPLE_STEP;
+
+        for (size_t channel = 0; channel < NOISE_CHANNEL_COUNT; ++channel)
+        {
+            const std::vector<float>& region = regionGrids[channel];
+            const std::vector<float>& chunk  = chunkGrids[channel];
+            CHECK(chunk.size() == CHUNK_NOISE_GRID_SIZE * CHUNK_NOISE_GRID_SIZE);
+
+            int mismatches = 0;
+            for (int z = 0; z < CHUNK_NOISE_GRID_SIZE; ++z)
+            {
+                for (int x = 0; x < CHUNK_NOISE_GRID_SIZE; ++x)
+                {
+                    float expected = region[(startZ + z) * NOISE_GRID_SIZE + startX + x];
+                    if (chunk[z * CHUNK_NOISE_GRID_SIZE + x] != expected)
+                        ++mismatches;
+                }
+            }
+            if (mismatches != 0)
+            {
+                reportFailure(__FILE__, __LINE__,
+                              describeChunk(chunkX, chunkZ) + ", channel " +
+                                  std::to_string(channel) + ": " + std::to_string(mismatches) +
+                                  " samples differ from the region grid");
+            }
+        }
+    }
+}
+
+TEST_CASE(chunkNoiseHeightsMatchRegionHeights)
+{
+    WorldGenerator generator = makeGenerator();
+
+    for (const auto& [chunkX, chunkZ] : chunkCoordinates)
+    {
+        NoiseChannelGrids regionGrids, chunkGrids;
+        generator.generateRegionNoiseGrids(regionGrids, floorDiv(chunkX, REGION_SIZE),
+                                           floorDiv(chunkZ, REGION_SIZE), frequency, seed);
+        generator.generateChunkNoiseGrids(chunkGrids, chunkX, chunkZ, frequency, seed);
+
+        // The two ways ChunkManager generates a chunk's heights
+        std::array<float, CHUNK_SIZE * CHUNK_SIZE> expected, actual;
+        generator.generateHeights(regionGrids, NOISE_GRID_SIZE,
+                                  (chunkX & (REGION_SIZE - 1)) * CHUNK_SIZE,
+                                  (chunkZ & (REGION_SIZE - 1)) * CHUNK_SIZE, expected);
+        generator.generateHeights(chunkGrids, CHUNK_NOISE_GRID_SIZE, 0, 0, actual);
+
+        if (actual != expected)
+        {
+            reportFailure(__FILE__, __LINE__,
+                          describeChunk(chunkX, chunkZ) +
+                              ": heights differ from the region grid's");
+        }
+    }
+}
@@ -0,0 +1,201 @@
+#include "spline.h"
+#include "test.h"
+#include "world_generator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+    // Uneven gaps, from a hundredth of the average gap upwards, and slopes of up to 100
+    Spline makeRandomSpline(unsigned seed, int pointCount)
+    {
+        std::mt19937                          random(seed);
+        std::uniform_real_distribution<float> gap(0.01f, 2.0f);
+        std::uniform_real_distribution<float> slope(-100.0f, 100.0f);
+
+        Spline spline;
+        float  input = -1.0f, output = 0.0f;
+        for (int i = 0; i < pointCount; ++i)
+        {
+            spline.addPoint(input, output);
+            float step = gap(random) / pointCount;
+            input += step;
+            output += slope(random) * step;
+        }
+        return spline;
+    }
+
+    // Nine equal kinks, closer together than a table cell is wide and all bending the same way,
+    // so a cell sized for one of them holds all nine and their errors add up. A third of the way
+    // into the range, they stay clear of cell boundaries for the table sizes tested.
+    Spline makeClusteredKinkSpline()
+    {
+        Spline spline;
+        spline.addPoint(-1.0f, 0.0f);
+        float input = -1.0f / 3.0f, output = 0.0f, slope = 0.0f;
+        for (int i = 0; i < 9; ++i)
+        {
+            spline.addPoint(input, output);
+            slope += 10.0f;
+            input += 1e-5f;
+            output += slope * 1e-5f;
+        }
+        spline.addPoint(1.0f, output + slope * (1.0f - input));
+        return spline;
+    }
+
+    std::vector<Spline> makeTestSplines()
+    {
+        WorldGenerator      generator(0);
+        std::vector<Spline> splines = {generator.continentSpline, generator.erosionSpline,
+                                       makeClusteredKinkSpline()};
+        for (unsigned seed = 0; seed < 16; ++seed)
+            splines.push_back(makeRandomSpline(seed, 3 + seed * 3));
+        return splines;
+    }
+
+    float evaluateBatched(const Spline& spline, float input)
+    {
+        float output;
+        spline.evaluateBatch(&input, &output, 1);
+        return output;
+    }
+
+    std::string describe(float input, float actual, float expected)
+    {
+        return "input " + std::to_string(input) + ": " + std::to_string(actual) + " instead of " +
+               std::to_string(expected);
+    }
+}  // namespace
+
+TEST_CASE(exactSplineTableMatchesEvaluateAroundPoints)
+{
+    for (Spline& spline : makeTestSplines())
+    {
+        spline.compile(0.0f);
+        for (const SplinePoint& point : spline.getPoints())
+        {
+            const float inputs[] = {
+                std::nextafter(point.input, -std::numeric_limits<float>::infinity()),
+                point.input,
+                std::nextafter(point.input, std::numeric_limits<float>::infinity()),
+            };
+            for (float input : inputs)
+            {
+                float expected = spline.evaluate(input);
+                float actual   = evaluateBatched(spline, input);
+                if (actual != expected)
+                    reportFailure(__FILE__, __LINE__, describe(input, actual, expected));
+            }
+        }
+    }
+}
+
+TEST_CASE(exactSplineTableMatchesEvaluateAcrossRange)
+{
+    for (Spline& spline : makeTestSplines())
+    {
+        spline.compile(0.0f);
+        float start = spline.getPoints().front().input;
+        float range = spline.getPoints().back().input - start;
+
+        std::vector<float> inputs(10000), outputs(inputs.size());
+        for (size_t i = 0; i < inputs.size(); ++i)
+            inputs[i] = start + range * i / (inputs.size() - 1);
+        spline.evaluateBatch(inputs.data(), outputs.data(), inputs.size());
+
+        for (size_t i = 0; i < inputs.size(); ++i)
+        {
+            float expected = spline.evaluate(inputs[i]);
+            if (outputs[i] != expected)
+            {
+                reportFailure(__FILE__, __LINE__, describe(inputs[i], outputs[i], expected));
+                break;
+            }
+        }
+    }
+}
+
+TEST_CASE(approximateSplineTableStaysWithinMaxError)
+{
+    for (float maxError : {1.0f, 0.1f, 0.01f})
+    {
+        for (Spline& spline : makeTestSplines())
+        {
+            spline.compile(maxError);
+            const std::vector<SplinePoint>& points = spline.getPoints();
+
+            // Dense samples plus the points themselves and their neighbors, where errors peak
+            std::vector<float> inputs;
+            float              start = points.front().input;
+            float              range = points.back().input - start;
+            for (int i = 0; i <= 100000; ++i)
+                inputs.push_back(start + range * i / 100000);
+            for (const SplinePoint& point : points)
+            {
+                inputs.push_back(std::nextafter(point.input, start));
+                inputs.push_back(point.input);
+                inputs.push_back(std::nextafter(point.input, points.back().input));
+            }
+
+            std::vector<float> outputs(inputs.size());
+            spline.evaluateBatch(inputs.data(), outputs.data(), inputs.size());
+
+            for (size_t i = 0; i < inputs.size(); ++i)
+            {
+                float expected = spline.evaluate(inputs[i]);
+                if (std::abs(outputs[i] - expected) > maxError)
+                {
+                    reportFailure(__FILE__, __LINE__,
+                                  "maxError " + std::to_string(maxError) + ", " +
+                                      describe(inputs[i], outputs[i], expected));
+                    break;
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE(splineBatchClampsOutOfRangeInputs)
+{
+    const float inf = std::numeric_limits<float>::infinity();
+
+    auto checkClamped = [&](const Spline& spline)
+    {
+        const SplinePoint& first = spline.getPoints().front();
+        const SplinePoint& last  = spline.getPoints().back();
+
+        const float below[] = {std::nextafter(first.input, -inf), first.input - 1.0f, -1e30f, -inf};
+        const float above[] = {std::nextafter(last.input, inf), last.input + 1.0f, 1e30f, inf};
+        for (float input : below)
+            CHECK(evaluateBatched(spline, input) == first.output);
+        for (float input : above)
+            CHECK(evaluateBatched(spline, input) == last.output);
+    };
+
+    for (Spline& spline : makeTestSplines())
+    {
+        checkClamped(spline);  // Not compiled yet
+        spline.compile(0.0f);
+        checkClamped(spline);
+        spline.compile(0.1f);
+        checkClamped(spline);
+    }
+}
+
+TEST_CASE(splineTableTooLargeForMaxErrorThrows)
+{
+    WorldGenerator generator(0);
+    Spline         spline = generator.continentSpline;
+    CHECK_THROWS(spline.compile(1e-6f), std::invalid_argument);
+
+    // A failed compile leaves the spline usable through evaluate()
+    float input = 0.25f, output;
+    spline.evaluateBatch(&input, &output, 1);
+    CHECK(output == spline.evaluate(input));
+}
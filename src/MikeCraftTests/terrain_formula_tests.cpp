@@ -0,0 +1,138 @@
+#include "terrain_formula.h"
+#include "test.h"
+
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+    constexpr uint32_t continentBit = 1u << static_cast<uint32_t>(NoiseChannel::CONTINENT);
+    constexpr uint32_t erosionBit   = 1u << static_cast<uint32_t>(NoiseChannel::EROSION);
+    constexpr uint32_t pvBit        = 1u << static_cast<uint32_t>(NoiseChannel::PV);
+
+    // Empty channels are passed as null, as generateHeights does for channels the kernel skips
+    std::vector<float> runKernel(const TerrainKernel& kernel, const std::vector<float>& continent,
+                                 const std::vector<float>& erosion, const std::vector<float>& pv)
+    {
+        const std::vector<float>* values[NOISE_CHANNEL_COUNT] = {&continent, &erosion, &pv};
+
+        std::array<const float*, NOISE_CHANNEL_COUNT> channels{};
+        size_t                                        count = 0;
+        for (size_t i = 0; i < NOISE_CHANNEL_COUNT; ++i)
+        {
+            if (!values[i]->empty())
+            {
+                channels[i] = values[i]->data();
+                count       = values[i]->size();
+            }
+        }
+        // Garbage in the outputs shows up if the kernel skips writing a column
+        std::vector<float> outputs(count, -12345.0f);
+        kernel.evaluateBatch(channels, outputs.data(), count);
+        return outputs;
+    }
+
+    Spline makeLinearSpline(float fromOutput, float toOutput)
+    {
+        Spline spline;
+        spline.addPoint(-1.0f, fromOutput);
+        spline.addPoint(1.0f, toOutput);
+        return spline;
+    }
+}  // namespace
+
+TEST_CASE(evaluateBatchMatchesHandComputedValues)
+{
+    // continent * erosion + pv * 10
+    TerrainFormula       formula;
+    TerrainFormula::Node continent = formula.noise(NoiseChannel::CONTINENT);
+    TerrainFormula::Node erosion   = formula.noise(NoiseChannel::EROSION);
+    TerrainFormula::Node pv        = formula.noise(NoiseChannel::PV);
+    TerrainFormula::Node height    = formula.add(formula.multiply(continent, erosion),
+                                                 formula.multiply(pv, formula.constant(10.0f)));
+    TerrainKernel        kernel    = formula.compile(height);
+
+    std::vector<float> outputs =
+        runKernel(kernel, {1.0f, 2.0f, -3.0f}, {0.5f, -1.0f, 2.0f}, {0.25f, 0.0f, -1.0f});
+    CHECK(outputs == std::vector<float>({3.0f, -2.0f, -16.0f}));
+}
+
+TEST_CASE(compilePrunesUnusedNodesAndRemapsInputs)
+{
+    TerrainFormula formula;
+    formula.noise(NoiseChannel::EROSION);
+    TerrainFormula::Node continent = formula.noise(NoiseChannel::CONTINENT);
+
+    // More unused nodes than a kernel may hold, between and among the used ones
+    TerrainFormula::Node unused = formula.constant(1000.0f);
+    for (size_t i = 0; i < TerrainKernel::MAX_INSTRUCTIONS; ++i)
+        unused = formula.add(unused, continent);
+    formula.spline(makeLinearSpline(500.0f, 600.0f), formula.noise(NoiseChannel::PV));
+
+    // 2 * continent + spline(continent), with the spline mapping [-1, 1] onto [0, 10]
+    TerrainFormula::Node twice  = formula.multiply(continent, formula.constant(2.0f));
+    TerrainFormula::Node curved = formula.spline(makeLinearSpline(0.0f, 10.0f), continent);
+    formula.add(unused, curved);
+    TerrainFormula::Node height = formula.add(twice, curved);
+
+    TerrainKernel kernel = formula.compile(height);
+    CHECK(kernel.getChannelMask() == continentBit);
+
+    std::vector<float> outputs = runKernel(kernel, {-1.0f, -0.5f, 0.0f, 0.25f, 1.0f}, {}, {});
+    CHECK(outputs == std::vector<float>({-2.0f, 1.5f, 5.0f, 6.75f, 12.0f}));
+}
+
+TEST_CASE(compileRejectsTooManyUsedNodes)
+{
+    TerrainFormula       formula;
+    TerrainFormula::Node sum = formula.noise(NoiseChannel::CONTINENT);
+    for (size_t i = 0; i < TerrainKernel::MAX_INSTRUCTIONS; ++i)
+        sum = formula.add(sum, sum);
+
+    CHECK_THROWS(formula.compile(sum), std::length_error);
+}
+
+TEST_CASE(channelMaskHoldsOnlyChannelsTheOutputReads)
+{
+    TerrainFormula       formula;
+    TerrainFormula::Node continent = formula.noise(NoiseChannel::CONTINENT);
+    TerrainFormula::Node erosion   = formula.noise(NoiseChannel::EROSION);
+    TerrainFormula::Node pv        = formula.noise(NoiseChannel::PV);
+    TerrainFormula::Node constant  = formula.constant(4.0f);
+    TerrainFormula::Node all       = formula.add(formula.add(continent, erosion), pv);
+
+    CHECK(formula.compile(all).getChannelMask() == (continentBit | erosionBit | pvBit));
+    CHECK(formula.compile(formula.multiply(pv, erosion)).getChannelMask() == (erosionBit | pvBit));
+    CHECK(formula.compile(pv).getChannelMask() == pvBit);
+    CHECK(formula.compile(constant).getChannelMask() == 0);
+
+    TerrainKernel pvOnly = formula.compile(pv);
+    CHECK(pvOnly.usesChannel(NoiseChannel::PV));
+    CHECK(!pvOnly.usesChannel(NoiseChannel::CONTINENT));
+    CHECK(!pvOnly.usesChannel(NoiseChannel::EROSION));
+
+    // A kernel that was never compiled reads nothing and outputs 0
+    TerrainKernel empty;
+    CHECK(empty.getChannelMask() == 0);
+    CHECK(runKernel(empty, {}, {}, {1.0f, 2.0f}) == std::vector<float>({0.0f, 0.0f}));
+}
+
+TEST_CASE(compileHandlesLastPossibleNodeIndex)
+{
+    // The output is node UINT16_MAX, so a 16-bit loop counter over the nodes would wrap forever
+    TerrainFormula       formula;
+    TerrainFormula::Node pv = formula.noise(NoiseChannel::PV);
+    for (int i = 1; i < UINT16_MAX - 1; ++i)
+        formula.constant(static_cast<float>(i));
+    TerrainFormula::Node three  = formula.constant(3.0f);
+    TerrainFormula::Node height = formula.multiply(pv, three);
+    CHECK(height == UINT16_MAX);
+
+    TerrainKernel kernel = formula.compile(height);
+    CHECK(kernel.getChannelMask() == pvBit);
+    CHECK(runKernel(kernel, {}, {}, {-1.0f, 0.5f}) == std::vector<float>({-3.0f, 1.5f}));
+
+    // Node indices are 16 bits, so there is no room for another node
+    CHECK_THROWS(formula.constant(0.0f), std::length_error);
+}
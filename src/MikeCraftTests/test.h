@@ -0,0 +1,51 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Minimal self-registering test cases. main runs every registered case and fails the process if
+// any check failed, so the tests can run as a build step.
+struct TestCase
+{
+    const char* name;
+    void (*run)();
+};
+
+std::vector<TestCase>& getTestCases();
+void                   reportFailure(const char* file, int line, const std::string& message);
+
+struct TestRegistration
+{
+    TestRegistration(const char* name, void (*run)())
+    {
+        getTestCases().push_back({name, run});
+    }
+};
+
+#define TEST_CASE(name)                                      \
+    static void             name();                          \
+    static TestRegistration name##Registration(#name, name); \
+    static void             name()
+
+#define CHECK(condition)                                   \
+    do                                                     \
+    {                                                      \
+        if (!(condition))                                  \
+            reportFailure(__FILE__, __LINE__, #condition); \
+    } while (false)
+
+#define CHECK_THROWS(expression, exceptionType)                                              \
+    do                                                                                       \
+    {                                                                                        \
+        bool thrown = false;                                                                 \
+        try                                                                                  \
+        {                                                                                    \
+            expression;                                                                      \
+        }                                                                                    \
+        catch (const exceptionType&)                                                         \
+        {                                                                                    \
+            thrown = true;                                                                   \
+        }                                                                                    \
+        if (!thrown)                                                                         \
+            reportFailure(__FILE__, __LINE__, #expression " did not throw " #exceptionType); \
+    } while (false)